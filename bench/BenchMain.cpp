@@ -0,0 +1,239 @@
+#include "FixtureGenerator.h"
+#include "core/ConfigManager.h"
+#include "core/FfmpegManager.h"
+#include "core/PatternManager.h"
+#include "core/FileScanner.h"
+#include "core/DanmakuConverter.h"
+#include "core/MergeThread.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QDir>
+#include <QFileInfo>
+#include <cstdio>
+
+/**
+ * @brief 性能测试程序
+ * 在临时目录生成测试缓存，分别计时扫描、弹幕转换和合并，结果输出到标准输出
+ *
+ * 用法: bilicache_bench [--entries N] [--danmaku N] [--merge-entries N] [-j N] [--ffmpeg path]
+ * 未提供可用的FFmpeg时跳过合并测试
+ */
+
+namespace {
+
+void printResult(const char *name, const QString &detail, qint64 nsecs, double items, const char *unit)
+{
+    double msecs = nsecs / 1e6;
+    double rate = nsecs > 0 ? items * 1e9 / nsecs : 0.0;
+    std::printf("%-22s %-28s %10.1f ms %12.1f %s/s\n",
+                name, detail.toUtf8().constData(), msecs, rate, unit);
+    std::fflush(stdout);
+}
+
+qint64 runMerge(ConfigManager &config, FfmpegManager &ffmpeg, PatternManager &patterns,
+                const QString &inputPath, const QString &outputPath, int concurrency, int &merged)
+{
+    MergeThread::MergeConfig mergeConfig;
+    mergeConfig.inputPath = inputPath;
+    mergeConfig.outputPath = outputPath;
+    mergeConfig.patternName = "Android";
+    mergeConfig.danmuEnabled = false;
+    mergeConfig.coverEnabled = false;
+    mergeConfig.subtitleEnabled = false;
+    mergeConfig.oneDir = true;
+    mergeConfig.ordered = false;
+    mergeConfig.overwrite = true;
+    mergeConfig.errorSkip = true;
+    mergeConfig.concurrency = concurrency;
+    mergeConfig.reserveBytes = 0;
+
+    MergeThread thread;
+    thread.setConfig(mergeConfig);
+    thread.setConfigManager(&config);
+    thread.setFfmpegManager(&ffmpeg);
+    thread.setPatternManager(&patterns);
+
+    merged = 0;
+    QObject::connect(&thread, &MergeThread::mergeCompleted, &thread,
+                     [&merged](int success, int) { merged = success; }, Qt::DirectConnection);
+
+    QElapsedTimer timer;
+    timer.start();
+    thread.start();
+    thread.wait();
+    return timer.nsecsElapsed();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    // 使用独立的配置目录，不影响正常使用的配置文件
+    app.setApplicationName("BiliCacheMergeBench");
+    app.setOrganizationName("BiliCacheMerge");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("BiliCacheMerge 性能测试");
+    parser.addHelpOption();
+
+    QCommandLineOption entriesOption("entries", "扫描测试的分集数（默认: 2000）", "n", "2000");
+    QCommandLineOption danmakuOption("danmaku", "弹幕转换测试的弹幕条数（默认: 50000）", "n", "50000");
+    QCommandLineOption mergeEntriesOption("merge-entries", "合并测试的分集数（默认: 40）", "n", "40");
+    QCommandLineOption concurrencyOption(QStringList() << "j" << "concurrency",
+                                         "合并测试的并发数（默认: 4）", "n", "4");
+    QCommandLineOption ffmpegOption("ffmpeg", "FFmpeg可执行文件路径", "path");
+    QCommandLineOption patternOption("pattern-dir", "模式文件目录", "dir", BILICACHE_PATTERN_DIR);
+    QCommandLineOption layoutOption("layout", "扫描测试的缓存布局，见bilicache_fixturegen（默认: Android）",
+                                    "name", "Android");
+    QCommandLineOption keepOption("keep", "保留生成的测试目录");
+    parser.addOptions({entriesOption, danmakuOption, mergeEntriesOption, concurrencyOption,
+                       ffmpegOption, patternOption, layoutOption, keepOption});
+    parser.process(app);
+
+    int entries = qMax(1, parser.value(entriesOption).toInt());
+    int danmakuCount = qMax(1, parser.value(danmakuOption).toInt());
+    int mergeEntries = qMax(1, parser.value(mergeEntriesOption).toInt());
+    int concurrency = qMax(1, parser.value(concurrencyOption).toInt());
+
+    FixtureGenerator::Layout layout;
+    if (!FixtureGenerator::layoutFromName(parser.value(layoutOption), layout)) {
+        std::fprintf(stderr, "未知布局: %s\n", parser.value(layoutOption).toUtf8().constData());
+        return 2;
+    }
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid()) {
+        std::fprintf(stderr, "无法创建临时目录\n");
+        return 1;
+    }
+    workDir.setAutoRemove(!parser.isSet(keepOption));
+    std::printf("测试目录: %s\n\n", QDir::toNativeSeparators(workDir.path()).toUtf8().constData());
+
+    ConfigManager config;
+    config.setCustomPermission(true);
+    config.setPatternFilePath(parser.value(patternOption));
+    if (parser.isSet(ffmpegOption)) {
+        config.setFfmpegPath(parser.value(ffmpegOption));
+    }
+
+    FfmpegManager ffmpeg(&config);
+    PatternManager patterns(&config);
+    QElapsedTimer timer;
+
+    // 生成扫描用缓存（占位媒体）
+    QString scanRoot = QDir(workDir.path()).filePath("scan");
+    FixtureGenerator::Options scanOptions;
+    scanOptions.layout = layout;
+    scanOptions.entries = entries;
+    scanOptions.danmakuPerEntry = 0;
+    FixtureGenerator scanFixtures(scanOptions);
+    QString error;
+
+    timer.start();
+    if (!scanFixtures.generate(scanRoot, error)) {
+        std::fprintf(stderr, "%s\n", error.toUtf8().constData());
+        return 1;
+    }
+    printResult("fixture.generate", QString("%1 entries=%2").arg(FixtureGenerator::layoutName(layout)).arg(entries),
+                timer.nsecsElapsed(), entries, "entries");
+
+    // 扫描：指定模式和尝试全部模式（Blv没有对应的模式文件）
+    QStringList scanPatterns;
+    if (layout != FixtureGenerator::Blv) {
+        scanPatterns << FixtureGenerator::layoutName(layout);
+    }
+    scanPatterns << QString();
+    for (const QString &patternName : scanPatterns) {
+        FileScanner scanner(&config, &patterns);
+        FileScanner::ScanConfig scanConfig;
+        scanConfig.searchPath = scanRoot;
+        scanConfig.patternName = patternName;
+        scanConfig.oneDir = true;
+        scanConfig.overwrite = false;
+        scanConfig.danmuEnabled = false;
+        scanConfig.coverEnabled = false;
+        scanConfig.subtitleEnabled = false;
+        scanConfig.ordered = false;
+
+        timer.start();
+        scanner.scan(scanConfig);
+        qint64 elapsed = timer.nsecsElapsed();
+
+        QString detail = QString("pattern=%1 found=%2")
+                         .arg(patternName.isEmpty() ? "all" : patternName)
+                         .arg(scanner.totalFiles());
+        printResult("scan", detail, elapsed, scanner.totalFiles(), "entries");
+    }
+
+    // 弹幕转换
+    QString danmakuXml = QDir(workDir.path()).filePath("danmaku.xml");
+    QString danmakuAss = QDir(workDir.path()).filePath("danmaku.ass");
+    if (!FixtureGenerator::writeDanmakuXml(danmakuXml, danmakuCount, 1)) {
+        std::fprintf(stderr, "无法生成弹幕文件\n");
+        return 1;
+    }
+
+    for (bool reduce : {false, true}) {
+        DanmakuConfig danmakuConfig;
+        danmakuConfig.fontSize = 25;
+        danmakuConfig.textOpacity = 0.6;
+        danmakuConfig.durationMarquee = 12.0;
+        danmakuConfig.durationStill = 6.0;
+        danmakuConfig.reverseBlank = 0.67;
+        danmakuConfig.reduceComments = reduce;
+        danmakuConfig.stageWidth = 1080;
+        danmakuConfig.stageHeight = 720;
+        danmakuConfig.fontFace = "sans-serif";
+
+        DanmakuConverter converter;
+        timer.start();
+        bool ok = converter.convertToASS(danmakuXml, danmakuAss, danmakuConfig);
+        qint64 elapsed = timer.nsecsElapsed();
+
+        QString detail = QString("items=%1 reduce=%2%3").arg(danmakuCount).arg(reduce ? 1 : 0)
+                         .arg(ok ? "" : " FAILED");
+        printResult("danmaku.convertToASS", detail, elapsed, danmakuCount, "items");
+    }
+
+    // 合并：需要可用的FFmpeg生成真实样本
+    if (!ffmpeg.isValidFfmpegPath()) {
+        std::printf("\n跳过合并测试: FFmpeg不可用 (%s)，可用 --ffmpeg 指定\n",
+                    ffmpeg.ffmpegPath().toUtf8().constData());
+        return 0;
+    }
+
+    FixtureGenerator::Samples samples;
+    if (!FixtureGenerator::createSamples(&ffmpeg, workDir.path(), samples, error)) {
+        std::printf("\n跳过合并测试: %s\n", error.toUtf8().constData());
+        return 0;
+    }
+
+    QString mergeRoot = QDir(workDir.path()).filePath("merge");
+    FixtureGenerator::Options mergeOptions;
+    mergeOptions.entries = mergeEntries;
+    mergeOptions.danmakuPerEntry = 0;
+    mergeOptions.samples = samples;
+    FixtureGenerator mergeFixtures(mergeOptions);
+    if (!mergeFixtures.generate(mergeRoot, error)) {
+        std::fprintf(stderr, "%s\n", error.toUtf8().constData());
+        return 1;
+    }
+
+    QList<int> levels = {1};
+    if (concurrency > 1) {
+        levels.append(concurrency);
+    }
+    for (int level : levels) {
+        QString outputPath = QDir(workDir.path()).filePath(QString("out_j%1").arg(level));
+        int merged = 0;
+        qint64 elapsed = runMerge(config, ffmpeg, patterns, mergeRoot, outputPath, level, merged);
+        printResult("merge", QString("files=%1 j=%2 ok=%3").arg(mergeEntries).arg(level).arg(merged),
+                    elapsed, merged, "files");
+    }
+
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include "DanmakuBench.h"
+#include "FixtureGenerator.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QXmlStreamReader>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QSysInfo>
+#include <algorithm>
+
+DanmakuBench::DanmakuBench(const Options &options)
+    : m_options(options)
+{
+    m_options.repeat = qMax(1, m_options.repeat);
+}
+
+QJsonObject DanmakuBench::run()
+{
+    QJsonArray results;
+    for (int count : m_options.sizes) {
+        results.append(runSize(count));
+    }
+
+    QJsonObject report;
+    report["benchmark"] = "danmaku";
+    report["version"] = "2.0.0";
+    report["qt"] = QString::fromLatin1(qVersion());
+    report["cpu"] = QSysInfo::currentCpuArchitecture();
+    report["os"] = QSysInfo::prettyProductName();
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["repeat"] = m_options.repeat;
+    report["results"] = results;
+    return report;
+}
+
+QJsonObject DanmakuBench::runSize(int count)
+{
+    QString xmlPath = QDir(m_options.workDir).filePath(QString("danmaku_%1.xml").arg(count));
+    QString assPath = QDir(m_options.workDir).filePath(QString("danmaku_%1.ass").arg(count));
+
+    QJsonObject result;
+    result["comments"] = count;
+
+    if (!FixtureGenerator::writeDanmakuXml(xmlPath, count, m_options.seed)) {
+        result["error"] = QString("无法生成弹幕文件: %1").arg(xmlPath);
+        return result;
+    }
+    qint64 xmlBytes = QFileInfo(xmlPath).size();
+    result["xml_bytes"] = static_cast<double>(xmlBytes);
+
+    QJsonObject stages;
+    DanmakuConfig config = defaultConfig(false);
+    const QString styleId = "Danmaku2ASS_bench";
+
+    // XML解析
+    QList<DanmakuItem> parsed;
+    Timing parseTiming = measure([&parsed]() { parsed.clear(); },
+                                 [this, &xmlPath, &parsed]() { parseFile(xmlPath, parsed); });
+    QJsonObject parseStage = stageResult(parseTiming, parsed.size(), xmlBytes);
+    parseStage["parsed"] = parsed.size();
+    stages["parse"] = parseStage;
+
+    // 与convertToASS一致，按时间排序后再过滤和排版
+    std::stable_sort(parsed.begin(), parsed.end(), [](const DanmakuItem &a, const DanmakuItem &b) {
+        return a.time < b.time;
+    });
+
+    // 重复过滤
+    if (parsed.size() <= m_options.maxFilterItems) {
+        QList<DanmakuItem> filtered;
+        Timing filterTiming = measure([&filtered, &parsed]() { filtered = parsed; },
+                                      [this, &filtered]() { m_converter.filterDuplicates(filtered); });
+        QJsonObject filterStage = stageResult(filterTiming, parsed.size(), xmlBytes);
+        filterStage["kept"] = filtered.size();
+        stages["filter_duplicates"] = filterStage;
+    } else {
+        QJsonObject skipped;
+        skipped["skipped"] = true;
+        skipped["reason"] = QString("超过 --max-filter-items (%1)").arg(m_options.maxFilterItems);
+        stages["filter_duplicates"] = skipped;
+    }
+
+    // 轨道排版
+    QList<int> placement;
+    Timing layoutTiming = measure([&placement]() { placement.clear(); },
+                                  [this, &placement, &parsed, &config]() {
+                                      placement = m_converter.layoutComments(parsed, config);
+                                  });
+    int placed = static_cast<int>(std::count_if(placement.begin(), placement.end(),
+                                                [](int row) { return row >= 0; }));
+
+    // ASS输出（写入内存，不含磁盘IO）
+    QByteArray assData;
+    Timing emitTiming = measure([&assData]() { assData.clear(); },
+                                [this, &assData, &parsed, &placement, &config, &styleId]() {
+                                    QBuffer buffer(&assData);
+                                    buffer.open(QIODevice::WriteOnly);
+                                    QTextStream output(&buffer);
+                                    output.setEncoding(QStringConverter::Utf8);
+                                    m_converter.writeASSHeader(output, config, styleId);
+                                    m_converter.emitComments(parsed, placement, output, config, styleId);
+                                    output.flush();
+                                });
+
+    QJsonObject layoutStage = stageResult(layoutTiming, parsed.size(), assData.size());
+    layoutStage["placed"] = placed;
+    stages["layout"] = layoutStage;
+
+    QJsonObject emitStage = stageResult(emitTiming, parsed.size(), assData.size());
+    emitStage["ass_bytes"] = static_cast<double>(assData.size());
+    stages["emit"] = emitStage;
+
+    // 完整转换（含文件读写），分别测不减少和减少重复弹幕
+    for (bool reduce : {false, true}) {
+        if (reduce && count > m_options.maxFilterItems) {
+            continue;
+        }
+        DanmakuConfig convertConfig = defaultConfig(reduce);
+        bool ok = true;
+        Timing convertTiming = measure(nullptr, [this, &xmlPath, &assPath, &convertConfig, &ok]() {
+            ok = m_converter.convertToASS(xmlPath, assPath, convertConfig) && ok;
+        });
+        QJsonObject convertStage = stageResult(convertTiming, count, xmlBytes);
+        convertStage["success"] = ok;
+        stages[reduce ? "convert_to_ass_reduce" : "convert_to_ass"] = convertStage;
+    }
+
+    QFile::remove(xmlPath);
+    QFile::remove(assPath);
+
+    result["stages"] = stages;
+    return result;
+}
+
+DanmakuBench::Timing DanmakuBench::measure(const std::function<void()> &setup,
+                                           const std::function<void()> &body)
+{
+    Timing timing;
+    QElapsedTimer timer;
+
+    for (int i = 0; i < m_options.repeat; ++i) {
+        if (setup) {
+            setup();
+        }
+
+        timer.start();
+        body();
+        qint64 elapsed = timer.nsecsElapsed();
+
+        timing.totalNsecs += elapsed;
+        timing.runs++;
+        if (timing.runs == 1 || elapsed < timing.bestNsecs) {
+            timing.bestNsecs = elapsed;
+        }
+    }
+
+    return timing;
+}
+
+bool DanmakuBench::parseFile(const QString &xmlPath, QList<DanmakuItem> &items)
+{
+    QFile file(xmlPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QString format = m_converter.detectFormat(xmlPath);
+    QXmlStreamReader reader(&file);
+    while (!reader.atEnd()) {
+        if (reader.readNext() == QXmlStreamReader::StartElement && reader.name() == QLatin1String("i")) {
+            if (format == "Bilibili2") {
+                m_converter.parseBilibili2XML(reader, items);
+            } else {
+                m_converter.parseBilibiliXML(reader, items);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+QJsonObject DanmakuBench::stageResult(const Timing &timing, qint64 items, qint64 bytes)
+{
+    double seconds = timing.bestNsecs / 1e9;
+
+    QJsonObject stage;
+    stage["seconds"] = seconds;
+    stage["mean_seconds"] = timing.runs > 0 ? timing.totalNsecs / 1e9 / timing.runs : 0.0;
+    stage["items"] = static_cast<double>(items);
+    stage["bytes"] = static_cast<double>(bytes);
+    stage["items_per_sec"] = seconds > 0 ? items / seconds : 0.0;
+    stage["bytes_per_sec"] = seconds > 0 ? bytes / seconds : 0.0;
+    return stage;
+}
+
+DanmakuConfig DanmakuBench::defaultConfig(bool reduceComments)
+{
+    // 与MergeThread::convertDanmaku使用的参数一致
+    DanmakuConfig config;
+    config.fontSize = 25;
+    config.textOpacity = 0.6;
+    config.durationMarquee = 12.0;
+    config.durationStill = 6.0;
+    config.reverseBlank = 0.67;
+    config.reduceComments = reduceComments;
+    config.stageWidth = 1080;
+    config.stageHeight = 720;
+    config.fontFace = "sans-serif";
+    return config;
+}
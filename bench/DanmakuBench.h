@@ -0,0 +1,55 @@
+#ifndef DANMAKUBENCH_H
+#define DANMAKUBENCH_H
+
+#include <QString>
+#include <QList>
+#include <QJsonObject>
+#include <functional>
+
+#include "core/DanmakuConverter.h"
+
+/**
+ * @brief 弹幕转换分阶段性能测试
+ * 对不同弹幕数量分别测量XML解析、重复过滤、轨道排版、ASS输出和完整转换，
+ * 每个阶段报告items/s和bytes/s，结果为JSON，便于跨版本对比
+ *
+ * 通过DanmakuConverter的友元访问各阶段的私有实现
+ */
+class DanmakuBench
+{
+public:
+    struct Options {
+        QList<int> sizes = {1000, 10000, 100000, 1000000};
+        int repeat = 3;                 // 每个阶段重复次数，取最短时间
+        int maxFilterItems = 100000;    // 超过此数量跳过重复过滤（复杂度随密度平方增长）
+        QString workDir;                // 存放生成的弹幕文件
+        quint32 seed = 1;
+    };
+
+    explicit DanmakuBench(const Options &options);
+
+    // 执行全部测试并返回报告
+    QJsonObject run();
+
+private:
+    struct Timing {
+        qint64 bestNsecs = 0;
+        qint64 totalNsecs = 0;
+        int runs = 0;
+    };
+
+    QJsonObject runSize(int count);
+
+    // 重复执行body并记录时间，setup在每次计时前执行且不计入
+    Timing measure(const std::function<void()> &setup, const std::function<void()> &body);
+
+    bool parseFile(const QString &xmlPath, QList<DanmakuItem> &items);
+
+    static QJsonObject stageResult(const Timing &timing, qint64 items, qint64 bytes);
+    static DanmakuConfig defaultConfig(bool reduceComments);
+
+    Options m_options;
+    DanmakuConverter m_converter;
+};
+
+#endif // DANMAKUBENCH_H
@@ -0,0 +1,72 @@
+#include "DanmakuBench.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <cstdio>
+
+/**
+ * @brief 弹幕转换性能测试
+ *
+ * 用法: bilicache_danmaku_bench [--sizes 1000,10000] [--repeat N] [-o result.json]
+ * 未指定输出文件时JSON写到标准输出
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("BiliCacheMergeBench");
+    app.setOrganizationName("BiliCacheMerge");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("弹幕转换分阶段性能测试，输出JSON");
+    parser.addHelpOption();
+
+    QCommandLineOption sizesOption("sizes", "弹幕条数列表，逗号分隔（默认: 1000,10000,100000,1000000）",
+                                   "list", "1000,10000,100000,1000000");
+    QCommandLineOption repeatOption("repeat", "每个阶段重复次数，取最短时间（默认: 3）", "n", "3");
+    QCommandLineOption maxFilterOption("max-filter-items", "超过此条数跳过重复过滤（默认: 100000）",
+                                       "n", "100000");
+    QCommandLineOption seedOption("seed", "随机种子（默认: 1）", "n", "1");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "结果输出文件", "file");
+    parser.addOptions({sizesOption, repeatOption, maxFilterOption, seedOption, outputOption});
+    parser.process(app);
+
+    DanmakuBench::Options options;
+    options.sizes.clear();
+    for (const QString &size : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        int value = size.trimmed().toInt(&ok);
+        if (!ok || value <= 0) {
+            std::fprintf(stderr, "无效的弹幕条数: %s\n", size.toUtf8().constData());
+            return 2;
+        }
+        options.sizes.append(value);
+    }
+    options.repeat = parser.value(repeatOption).toInt();
+    options.maxFilterItems = parser.value(maxFilterOption).toInt();
+    options.seed = parser.value(seedOption).toUInt();
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid()) {
+        std::fprintf(stderr, "无法创建临时目录\n");
+        return 1;
+    }
+    options.workDir = workDir.path();
+
+    DanmakuBench bench(options);
+    QByteArray json = QJsonDocument(bench.run()).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(outputOption)) {
+        QSaveFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+            std::fprintf(stderr, "无法写入结果文件: %s\n", parser.value(outputOption).toUtf8().constData());
+            return 1;
+        }
+    } else {
+        std::fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+    }
+
+    return 0;
+}
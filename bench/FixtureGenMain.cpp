@@ -0,0 +1,112 @@
+#include "FixtureGenerator.h"
+#include "core/ConfigManager.h"
+#include "core/FfmpegManager.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QDir>
+#include <cstdio>
+
+/**
+ * @brief 测试缓存生成工具
+ * 按各.pat布局生成指定规模的B站缓存目录树，供扫描、合并和弹幕转换的性能测试使用
+ *
+ * 用法: bilicache_fixturegen [选项] <输出目录>
+ *   bilicache_fixturegen --layout Android --entries 100000 --danmaku 0 /tmp/cache
+ *   bilicache_fixturegen --all-layouts --entries 200 --ffmpeg /usr/bin/ffmpeg /tmp/cache
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("BiliCacheMergeBench");
+    app.setOrganizationName("BiliCacheMerge");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("生成测试用B站缓存目录树");
+    parser.addHelpOption();
+    parser.addPositionalArgument("output", "输出目录");
+
+    QCommandLineOption layoutOption("layout",
+        "布局: Android, Android_movie, Bilili_cmdtool, UWP_xiaoyaocz_Ver3, WIN10_official, Blv（默认: Android）",
+        "name", "Android");
+    QCommandLineOption allLayoutsOption("all-layouts", "每种布局各生成一份，放在以布局命名的子目录中");
+    QCommandLineOption entriesOption("entries", "分集总数（默认: 1000）", "n", "1000");
+    QCommandLineOption perVideoOption("per-video", "每个视频（组）的分集数（默认: 10）", "n", "10");
+    QCommandLineOption danmakuOption("danmaku", "每集弹幕条数，0为不生成（默认: 200）", "n", "200");
+    QCommandLineOption segmentsOption("blv-segments", "Blv布局每集分段数（默认: 4）", "n", "4");
+    QCommandLineOption gapOption("blv-gap-every", "Blv布局每N集缺一个分段（默认: 0，不缺）", "n", "0");
+    QCommandLineOption typeTagOption("type-tag", "Android媒体子目录名（默认: 80）", "tag", "80");
+    QCommandLineOption seedOption("seed", "随机种子（默认: 1）", "n", "1");
+    QCommandLineOption ffmpegOption("ffmpeg", "用FFmpeg生成真实媒体样本，生成的缓存可实际合并", "path");
+    parser.addOptions({layoutOption, allLayoutsOption, entriesOption, perVideoOption, danmakuOption,
+                       segmentsOption, gapOption, typeTagOption, seedOption, ffmpegOption});
+    parser.process(app);
+
+    const QStringList positional = parser.positionalArguments();
+    if (positional.size() != 1) {
+        parser.showHelp(2);
+    }
+    QString rootPath = QDir(positional.first()).absolutePath();
+
+    QList<FixtureGenerator::Layout> layouts;
+    if (parser.isSet(allLayoutsOption)) {
+        layouts = {FixtureGenerator::Android, FixtureGenerator::AndroidMovie,
+                   FixtureGenerator::BililiCmdtool, FixtureGenerator::Uwp,
+                   FixtureGenerator::Win10, FixtureGenerator::Blv};
+    } else {
+        FixtureGenerator::Layout layout;
+        if (!FixtureGenerator::layoutFromName(parser.value(layoutOption), layout)) {
+            std::fprintf(stderr, "未知布局: %s\n", parser.value(layoutOption).toUtf8().constData());
+            return 2;
+        }
+        layouts.append(layout);
+    }
+
+    FixtureGenerator::Options options;
+    options.entries = qMax(1, parser.value(entriesOption).toInt());
+    options.entriesPerVideo = qMax(1, parser.value(perVideoOption).toInt());
+    options.danmakuPerEntry = qMax(0, parser.value(danmakuOption).toInt());
+    options.blvSegments = qMax(1, parser.value(segmentsOption).toInt());
+    options.blvGapEvery = qMax(0, parser.value(gapOption).toInt());
+    options.typeTag = parser.value(typeTagOption);
+    options.seed = parser.value(seedOption).toUInt();
+
+    QString error;
+    if (parser.isSet(ffmpegOption)) {
+        ConfigManager config;
+        config.setCustomPermission(true);
+        config.setFfmpegPath(parser.value(ffmpegOption));
+        FfmpegManager ffmpeg(&config);
+
+        QString sampleDir = QDir(rootPath).filePath(".samples");
+        QDir().mkpath(sampleDir);
+        if (!FixtureGenerator::createSamples(&ffmpeg, sampleDir, options.samples, error)) {
+            std::fprintf(stderr, "%s\n", error.toUtf8().constData());
+            return 3;
+        }
+    }
+
+    for (FixtureGenerator::Layout layout : layouts) {
+        options.layout = layout;
+        QString layoutRoot = layouts.size() > 1
+            ? QDir(rootPath).filePath(FixtureGenerator::layoutName(layout))
+            : rootPath;
+
+        FixtureGenerator generator(options);
+        QElapsedTimer timer;
+        timer.start();
+        if (!generator.generate(layoutRoot, error)) {
+            std::fprintf(stderr, "%s\n", error.toUtf8().constData());
+            return 1;
+        }
+
+        std::printf("%-20s entries=%-8d files=%-9d %10.1f MB %8.1f s\n",
+                    FixtureGenerator::layoutName(layout).toUtf8().constData(),
+                    options.entries, generator.filesWritten(),
+                    generator.bytesWritten() / (1024.0 * 1024.0),
+                    timer.elapsed() / 1000.0);
+    }
+
+    return 0;
+}
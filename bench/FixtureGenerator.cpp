@@ -0,0 +1,427 @@
+#include "FixtureGenerator.h"
+#include "core/FfmpegManager.h"
+#include "core/Utils.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+
+namespace {
+
+// 最小的MP4头部，足以通过FileScanner的扩展名和magic校验
+QByteArray placeholderMp4(const char *handler)
+{
+    QByteArray data;
+    data.append("\x00\x00\x00\x18", 4);
+    data.append("ftypiso5");
+    data.append("\x00\x00\x02\x00", 4);
+    data.append("iso6mp41");
+    data.append(handler);
+    data.append(QByteArray(1024, '\0'));
+    return data;
+}
+
+// 只有文件头、没有数据标签的FLV
+QByteArray placeholderFlv()
+{
+    QByteArray data("FLV\x01\x05\x00\x00\x00\x09\x00\x00\x00\x00", 13);
+    data.append(QByteArray(512, '\0'));
+    return data;
+}
+
+QByteArray placeholderJpeg()
+{
+    QByteArray data("\xff\xd8\xff\xe0\x00\x10JFIF\x00\x01\x01\x00\x00\x01\x00\x01\x00\x00", 20);
+    data.append("\xff\xd9", 2);
+    return data;
+}
+
+const char *kDanmakuTexts[] = {
+    "哈哈哈哈哈", "前方高能", "awsl", "2333333", "这里好评",
+    "弹幕护体", "第一次来", "名场面", "泪目", "好耶"
+};
+
+} // namespace
+
+FixtureGenerator::FixtureGenerator(const Options &options)
+    : m_options(options)
+    , m_filesWritten(0)
+    , m_bytesWritten(0)
+{
+    m_options.entriesPerVideo = qMax(1, m_options.entriesPerVideo);
+    m_options.blvSegments = qMax(1, m_options.blvSegments);
+}
+
+bool FixtureGenerator::generate(const QString &rootPath, QString &error)
+{
+    m_filesWritten = 0;
+    m_bytesWritten = 0;
+
+    if (!QDir().mkpath(rootPath)) {
+        error = QString("无法创建目录: %1").arg(rootPath);
+        return false;
+    }
+
+    switch (m_options.layout) {
+    case Android:
+        return generateAndroid(rootPath, false, false, error);
+    case AndroidMovie:
+        return generateAndroid(rootPath, true, false, error);
+    case Blv:
+        return generateAndroid(rootPath, false, true, error);
+    default:
+        return generateGrouped(rootPath, error);
+    }
+}
+
+bool FixtureGenerator::generateAndroid(const QString &rootPath, bool movie, bool blv, QString &error)
+{
+    // 普通视频: <avid>/c_<cid>/entry.json；番剧: s_<season_id>/<ep_id>/entry.json
+    for (int i = 0; i < m_options.entries; ++i) {
+        int videoIndex = i / m_options.entriesPerVideo;
+        int page = i % m_options.entriesPerVideo + 1;
+        int avid = 100000 + videoIndex;
+        qint64 cid = static_cast<qint64>(avid) * 100 + page;
+
+        QString entryDir = movie
+            ? QDir(rootPath).filePath(QString("s_%1/%2").arg(30000 + videoIndex).arg(cid))
+            : QDir(rootPath).filePath(QString("%1/c_%2").arg(avid).arg(cid));
+
+        QJsonObject entry;
+        entry["title"] = QString("测试视频%1").arg(avid);
+        entry["type_tag"] = m_options.typeTag;
+        entry["cover"] = QString("http://i0.hdslb.com/bfs/archive/%1.jpg").arg(avid);
+
+        if (movie) {
+            QJsonObject ep;
+            ep["av_id"] = avid;
+            ep["bvid"] = QString("BV1fx%1").arg(avid);
+            ep["episode_id"] = static_cast<double>(cid);
+            ep["index"] = QString::number(page);
+            ep["index_title"] = QString("第%1话").arg(page);
+            entry["season_id"] = QString::number(30000 + videoIndex);
+            entry["ep"] = ep;
+            entry["index_title"] = QString("第%1话").arg(page);
+        } else {
+            QJsonObject pageData;
+            pageData["cid"] = static_cast<double>(cid);
+            pageData["page"] = page;
+            pageData["part"] = QString("第%1集").arg(page);
+            entry["avid"] = avid;
+            entry["bvid"] = QString("BV1fx%1").arg(avid);
+            entry["page_data"] = pageData;
+        }
+
+        if (!writeJson(QDir(entryDir).filePath("entry.json"), entry)) {
+            error = QString("无法写入entry.json: %1").arg(entryDir);
+            return false;
+        }
+
+        bool mediaOk = blv
+            ? writeBlvSegments(entryDir, "entry", i)
+            : writeMediaPair(QDir(entryDir).filePath(m_options.typeTag), "video.m4s", "audio.m4s");
+        if (!mediaOk) {
+            error = QString("无法写入媒体文件: %1").arg(entryDir);
+            return false;
+        }
+
+        if (!writeDanmaku(QDir(entryDir).filePath("danmaku.xml"), i)) {
+            error = QString("无法写入弹幕: %1").arg(entryDir);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool FixtureGenerator::generateGrouped(const QString &rootPath, QString &error)
+{
+    Layout layout = m_options.layout;
+    int groups = (m_options.entries + m_options.entriesPerVideo - 1) / m_options.entriesPerVideo;
+    int remaining = m_options.entries;
+
+    for (int g = 0; g < groups; ++g) {
+        int aid = 200000 + g;
+        int parts = qMin(remaining, m_options.entriesPerVideo);
+        remaining -= parts;
+
+        QString title = QString("测试合集%1").arg(aid);
+        QString coverUrl = QString("http://i0.hdslb.com/bfs/archive/%1.jpg").arg(aid);
+        QString groupDir = QDir(rootPath).filePath(QString::number(aid));
+
+        // 组entry和封面
+        QJsonObject groupEntry;
+        QString groupEntryName;
+        QString coverName;
+        if (layout == BililiCmdtool) {
+            groupEntry["season_id"] = QString::number(aid);
+            groupEntry["aid"] = aid;
+            groupEntry["title"] = title;
+            groupEntry["cover"] = coverUrl;
+            groupEntryName = "info.json";
+            coverName = "cover.jpg";
+        } else if (layout == Uwp) {
+            groupEntry["id"] = aid;
+            groupEntry["title"] = title;
+            groupEntry["thumb"] = coverUrl;
+            groupEntryName = "info.json";
+            coverName = "thumb.jpg";
+        } else {
+            groupEntry["Aid"] = QString::number(aid);
+            groupEntry["Bid"] = QString("BV1gx%1").arg(aid);
+            groupEntry["Title"] = title;
+            groupEntry["CoverURL"] = coverUrl;
+            groupEntryName = QString::number(aid) + ".dvi";
+            coverName = "cover.jpg";
+        }
+
+        if (!writeJson(QDir(groupDir).filePath(groupEntryName), groupEntry)
+            || !writeMedia(QDir(groupDir).filePath(coverName), QString(), placeholderJpeg())) {
+            error = QString("无法写入视频组: %1").arg(groupDir);
+            return false;
+        }
+
+        for (int p = 1; p <= parts; ++p) {
+            int episodeIndex = g * m_options.entriesPerVideo + p - 1;
+            qint64 cid = static_cast<qint64>(aid) * 100 + p;
+            QString partTitle = QString("第%1集").arg(p);
+
+            QJsonObject entry;
+            QString episodeDir;
+            QString entryName;
+            QString danmakuName;
+            QString videoName = "video.m4s";
+            QString audioName = "audio.m4s";
+
+            if (layout == BililiCmdtool) {
+                episodeDir = QDir(groupDir).filePath(QString::number(p));
+                entry["aid"] = aid;
+                entry["cid"] = static_cast<double>(cid);
+                entry["title"] = partTitle;
+                entry["index"] = p;
+                entry["total"] = parts;
+                entryName = "info.json";
+                danmakuName = "danmaku.xml";
+            } else if (layout == Uwp) {
+                episodeDir = QDir(groupDir).filePath(QString::number(cid));
+                entry["id"] = aid;
+                entry["cid"] = static_cast<double>(cid);
+                entry["title"] = partTitle;
+                entry["index"] = p;
+                entryName = "info.json";
+                // %episode%.xml：episode为分集entry的文件名
+                danmakuName = "info.xml";
+            } else {
+                episodeDir = QDir(groupDir).filePath(QString::number(p));
+                entry["Aid"] = QString::number(aid);
+                entry["Bid"] = QString("BV1gx%1").arg(aid);
+                entry["Cid"] = QString::number(cid);
+                entry["Title"] = title;
+                entry["PartName"] = partTitle;
+                entry["PartNo"] = QString::number(p);
+                entry["TotalParts"] = parts;
+                entry["CoverURL"] = coverUrl;
+                // %group%.info / %group%_%episode%.xml
+                entryName = QString::number(aid) + ".info";
+                danmakuName = QString("%1_%2.xml").arg(p).arg(aid);
+                videoName = "video.mp4";
+                audioName = "audio1.mp4";
+            }
+
+            if (!writeJson(QDir(episodeDir).filePath(entryName), entry)
+                || !writeMediaPair(episodeDir, videoName, audioName)
+                || !writeDanmaku(QDir(episodeDir).filePath(danmakuName), episodeIndex)) {
+                error = QString("无法写入分集: %1").arg(episodeDir);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool FixtureGenerator::writeMediaPair(const QString &dir, const QString &videoName, const QString &audioName)
+{
+    if (!QDir().mkpath(dir)) {
+        return false;
+    }
+    return writeMedia(QDir(dir).filePath(videoName), m_options.samples.video, placeholderMp4("vide"))
+        && writeMedia(QDir(dir).filePath(audioName), m_options.samples.audio, placeholderMp4("soun"));
+}
+
+bool FixtureGenerator::writeBlvSegments(const QString &dir, const QString &prefix, int episodeIndex)
+{
+    // 按设置每隔若干集缺掉第二个分段，制造不连续的序号
+    bool withGap = m_options.blvGapEvery > 0 && m_options.blvSegments > 2
+                   && (episodeIndex + 1) % m_options.blvGapEvery == 0;
+
+    for (int n = 0; n < m_options.blvSegments; ++n) {
+        if (withGap && n == 1) {
+            continue;
+        }
+        QString path = QDir(dir).filePath(QString("%1_%2.blv").arg(prefix).arg(n));
+        if (!writeMedia(path, m_options.samples.segment, placeholderFlv())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FixtureGenerator::writeDanmaku(const QString &path, int episodeIndex)
+{
+    if (m_options.danmakuPerEntry <= 0) {
+        return true;
+    }
+
+    if (!writeDanmakuXml(path, m_options.danmakuPerEntry, m_options.seed * 7919u + episodeIndex)) {
+        return false;
+    }
+    m_filesWritten++;
+    m_bytesWritten += QFileInfo(path).size();
+    return true;
+}
+
+bool FixtureGenerator::writeJson(const QString &path, const QJsonObject &object)
+{
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+        return false;
+    }
+    return writeFile(path, QJsonDocument(object).toJson(QJsonDocument::Compact));
+}
+
+bool FixtureGenerator::writeMedia(const QString &path, const QString &sample, const QByteArray &placeholder)
+{
+    if (!sample.isEmpty()) {
+        // 样本文件硬链接到每个分集，大批量生成时几乎不占空间
+        if (!Utils::linkOrCopyFile(sample, path)) {
+            return false;
+        }
+        m_filesWritten++;
+        m_bytesWritten += QFileInfo(sample).size();
+        return true;
+    }
+
+    return writeFile(path, placeholder);
+}
+
+bool FixtureGenerator::writeFile(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    if (file.write(data) != data.size()) {
+        return false;
+    }
+    m_filesWritten++;
+    m_bytesWritten += data.size();
+    return true;
+}
+
+bool FixtureGenerator::createSamples(FfmpegManager *ffmpeg, const QString &dir, Samples &samples, QString &error)
+{
+    if (!ffmpeg || !ffmpeg->isValidFfmpegPath()) {
+        error = "FFmpeg不可用";
+        return false;
+    }
+
+    Samples result;
+    result.video = QDir(dir).filePath("sample_video.m4s");
+    result.audio = QDir(dir).filePath("sample_audio.m4s");
+    result.segment = QDir(dir).filePath("sample_segment.flv");
+
+    // 只使用FFmpeg内置编码器，不依赖libx264等外部库
+    const QString videoSource = "testsrc=duration=1:size=160x120:rate=15";
+    const QString audioSource = "sine=frequency=440:duration=1";
+
+    QList<QStringList> commands;
+    commands << (QStringList() << "-f" << "lavfi" << "-i" << videoSource
+                               << "-c:v" << "mpeg4" << "-f" << "mp4" << "-y" << result.video);
+    commands << (QStringList() << "-f" << "lavfi" << "-i" << audioSource
+                               << "-c:a" << "aac" << "-f" << "mp4" << "-y" << result.audio);
+    commands << (QStringList() << "-f" << "lavfi" << "-i" << videoSource
+                               << "-f" << "lavfi" << "-i" << audioSource
+                               << "-c:v" << "flv1" << "-c:a" << "aac" << "-shortest"
+                               << "-f" << "flv" << "-y" << result.segment);
+
+    for (const QStringList &arguments : commands) {
+        QString output;
+        if (!ffmpeg->executeFfmpeg(arguments, output, error)) {
+            error = QString("生成样本失败: %1").arg(error.trimmed().section('\n', -1));
+            return false;
+        }
+    }
+
+    samples = result;
+    return true;
+}
+
+bool FixtureGenerator::writeDanmakuXml(const QString &path, int count, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    const int textCount = static_cast<int>(sizeof(kDanmakuTexts) / sizeof(kDanmakuTexts[0]));
+
+    QByteArray data;
+    data.reserve(count * 96 + 256);
+    data.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?><i>"
+                "<chatserver>chat.bilibili.com</chatserver><chatid>0</chatid>"
+                "<mission>0</mission><maxlimit>3000</maxlimit><state>0</state>"
+                "<real_name>0</real_name><source>k-v</source>\n");
+
+    for (int i = 0; i < count; ++i) {
+        // 以滚动弹幕为主，混入少量顶部/底部弹幕
+        int roll = random.bounded(100);
+        int mode = roll < 85 ? 1 : (roll < 93 ? 5 : 4);
+        double time = random.bounded(1440000) / 1000.0;
+        int color = roll % 7 == 0 ? static_cast<int>(random.bounded(0xffffff)) : 16777215;
+
+        data.append("<d p=\"");
+        data.append(QByteArray::number(time, 'f', 3));
+        data.append(',');
+        data.append(QByteArray::number(mode));
+        data.append(",25,");
+        data.append(QByteArray::number(color));
+        data.append(',');
+        data.append(QByteArray::number(1600000000 + i));
+        data.append(",0,");
+        data.append(QByteArray::number(random.generate(), 16));
+        data.append(',');
+        data.append(QByteArray::number(i));
+        data.append("\">");
+        data.append(kDanmakuTexts[random.bounded(textCount)]);
+        data.append("</d>\n");
+    }
+
+    data.append("</i>\n");
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    return file.write(data) == data.size();
+}
+
+QString FixtureGenerator::layoutName(Layout layout)
+{
+    switch (layout) {
+    case Android:       return "Android";
+    case AndroidMovie:  return "Android_movie";
+    case BililiCmdtool: return "Bilili_cmdtool";
+    case Uwp:           return "UWP_xiaoyaocz_Ver3";
+    case Win10:         return "WIN10_official";
+    case Blv:           return "Blv";
+    }
+    return QString();
+}
+
+bool FixtureGenerator::layoutFromName(const QString &name, Layout &layout)
+{
+    for (Layout candidate : {Android, AndroidMovie, BililiCmdtool, Uwp, Win10, Blv}) {
+        if (layoutName(candidate).compare(name, Qt::CaseInsensitive) == 0) {
+            layout = candidate;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,89 @@
+#ifndef FIXTUREGENERATOR_H
+#define FIXTUREGENERATOR_H
+
+#include <QString>
+#include <QByteArray>
+#include <QJsonObject>
+
+class FfmpegManager;
+
+/**
+ * @brief 测试用B站缓存生成器
+ * 按pattern目录中各.pat描述的目录结构生成缓存树，用于在没有真实缓存的机器上
+ * 复现扫描、合并和弹幕转换的性能表现
+ *
+ * - Android / Android_movie: <视频>/<分集>/entry.json，媒体在type_tag子目录
+ * - Bilili_cmdtool / UWP_xiaoyaocz_Ver3: 组目录info.json + 每集子目录info.json
+ * - WIN10_official: 组目录<aid>.dvi + 每集子目录<aid>.info、video.mp4/audio1.mp4
+ * - Blv: Android结构，媒体为<entry>_<n>.blv分段
+ *
+ * 媒体文件默认为带文件头的占位数据，仅能通过扫描校验；
+ * 用createSamples()生成真实样本后硬链接到每个分集，可用于实际合并
+ */
+class FixtureGenerator
+{
+public:
+    enum Layout {
+        Android,
+        AndroidMovie,
+        BililiCmdtool,
+        Uwp,
+        Win10,
+        Blv
+    };
+
+    // 真实媒体样本（由FFmpeg生成，为空时写占位数据）
+    struct Samples {
+        QString video;      // MP4封装的视频流
+        QString audio;      // MP4封装的音频流
+        QString segment;    // FLV封装的音视频，用作BLV分段
+    };
+
+    struct Options {
+        Layout layout = Android;
+        int entries = 200;              // 分集总数
+        int entriesPerVideo = 10;       // 每个视频（组）下的分集数
+        int danmakuPerEntry = 200;      // 每个分集的弹幕条数，0为不生成
+        int blvSegments = 4;            // Blv布局每集的分段数
+        int blvGapEvery = 0;            // 每N集缺一个分段（测试连续性检查），0为不缺
+        QString typeTag = "80";         // Android媒体子目录
+        Samples samples;
+        quint32 seed = 1;               // 随机种子，相同种子生成相同内容
+    };
+
+    explicit FixtureGenerator(const Options &options);
+
+    // 生成缓存目录树，返回false时error为失败原因
+    bool generate(const QString &rootPath, QString &error);
+
+    // 生成的文件数和字节数（硬链接按样本大小计）
+    int filesWritten() const { return m_filesWritten; }
+    qint64 bytesWritten() const { return m_bytesWritten; }
+
+    // 用FFmpeg的lavfi测试源在dir中生成极小的真实样本
+    static bool createSamples(FfmpegManager *ffmpeg, const QString &dir, Samples &samples, QString &error);
+
+    // 生成单个弹幕文件
+    static bool writeDanmakuXml(const QString &path, int count, quint32 seed);
+
+    // 布局名称（与.pat文件名一致）
+    static QString layoutName(Layout layout);
+    static bool layoutFromName(const QString &name, Layout &layout);
+
+private:
+    bool generateAndroid(const QString &rootPath, bool movie, bool blv, QString &error);
+    bool generateGrouped(const QString &rootPath, QString &error);
+
+    bool writeMediaPair(const QString &dir, const QString &videoName, const QString &audioName);
+    bool writeBlvSegments(const QString &dir, const QString &prefix, int episodeIndex);
+    bool writeDanmaku(const QString &path, int episodeIndex);
+    bool writeJson(const QString &path, const QJsonObject &object);
+    bool writeMedia(const QString &path, const QString &sample, const QByteArray &placeholder);
+    bool writeFile(const QString &path, const QByteArray &data);
+
+    Options m_options;
+    int m_filesWritten;
+    qint64 m_bytesWritten;
+};
+
+#endif // FIXTUREGENERATOR_H
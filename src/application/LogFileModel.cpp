@@ -0,0 +1,330 @@
+#include "LogFileModel.h"
+#include <QFileInfo>
+#include <QtConcurrent>
+#include <cstring>
+
+namespace {
+
+// [start, end) 去掉行尾的\n和\r
+QString decodeLine(const uchar *data, qint64 start, qint64 end)
+{
+    while (end > start && (data[end - 1] == '\n' || data[end - 1] == '\r')) {
+        end--;
+    }
+    return QString::fromUtf8(reinterpret_cast<const char *>(data + start), end - start);
+}
+
+} // namespace
+
+LogFileModel::LogFileModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_data(nullptr)
+    , m_size(0)
+    , m_endsWithNewline(false)
+    , m_filtering(false)
+    , m_checkedLines(0)
+{
+    connect(&m_filterWatcher, &QFutureWatcher<QVector<int>>::finished,
+            this, &LogFileModel::onFilterFinished);
+}
+
+LogFileModel::~LogFileModel()
+{
+    m_filterWatcher.cancel();
+    m_filterWatcher.waitForFinished();
+}
+
+bool LogFileModel::openFile(const QString &filePath, QString *error)
+{
+    beginResetModel();
+
+    m_filterWatcher.cancel();
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+    m_lineStarts.clear();
+    m_endsWithNewline = false;
+    m_matchedLines.clear();
+    m_checkedLines = 0;
+
+    m_file.setFileName(filePath);
+    bool opened = m_file.open(QIODevice::ReadOnly);
+    if (!opened) {
+        if (error) {
+            *error = m_file.errorString();
+        }
+    } else {
+        qint64 size = m_file.size();
+        if (size > 0 && remap(size)) {
+            indexAppended(0, size);
+        }
+    }
+
+    endResetModel();
+
+    if (opened && m_filtering) {
+        setFilter(m_filter);
+    }
+    return opened;
+}
+
+void LogFileModel::close()
+{
+    beginResetModel();
+    m_filterWatcher.cancel();
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+    m_lineStarts.clear();
+    m_endsWithNewline = false;
+    m_matchedLines.clear();
+    m_checkedLines = 0;
+    endResetModel();
+}
+
+QString LogFileModel::filePath() const
+{
+    return m_file.fileName();
+}
+
+qint64 LogFileModel::indexedSize() const
+{
+    return m_size;
+}
+
+int LogFileModel::lineCount() const
+{
+    return m_lineStarts.size();
+}
+
+bool LogFileModel::refresh()
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+
+    // 路径上的文件变短说明被清空或轮转，重新打开
+    qint64 size = QFileInfo(m_file.fileName()).size();
+    if (size < m_size) {
+        return openFile(m_file.fileName());
+    }
+    if (size == m_size) {
+        return false;
+    }
+
+    int oldLines = m_lineStarts.size();
+    bool lastLineOpen = oldLines > 0 && !m_endsWithNewline;
+    qint64 oldSize = m_size;
+
+    if (!remap(size)) {
+        return false;
+    }
+    indexAppended(oldSize, size);
+
+    if (m_filtering) {
+        matchNewLines();
+        return true;
+    }
+
+    // 未写完的最后一行内容变了
+    if (lastLineOpen) {
+        QModelIndex last = index(oldLines - 1);
+        emit dataChanged(last, last, {Qt::DisplayRole});
+    }
+    if (m_lineStarts.size() > oldLines) {
+        beginInsertRows(QModelIndex(), oldLines, m_lineStarts.size() - 1);
+        endInsertRows();
+    }
+    return true;
+}
+
+void LogFileModel::setFilter(const QRegularExpression &filter)
+{
+    beginResetModel();
+
+    m_filterWatcher.cancel();
+    m_filter = filter;
+    m_filtering = !filter.pattern().isEmpty() && filter.isValid();
+    m_matchedLines.clear();
+    m_checkedLines = 0;
+
+    if (m_filtering && m_data) {
+        // 工作线程自己映射文件，只处理当前已写完整的行
+        m_checkedLines = completeLineCount();
+        m_filterWatcher.setFuture(QtConcurrent::run(&LogFileModel::matchLines,
+                                                    m_file.fileName(), m_lineStarts,
+                                                    m_checkedLines, m_size, m_filter));
+    }
+
+    endResetModel();
+}
+
+bool LogFileModel::isFiltering() const
+{
+    return m_filtering;
+}
+
+bool LogFileModel::isFilterPending() const
+{
+    return m_filtering && m_filterWatcher.isRunning();
+}
+
+QString LogFileModel::rowText(int row) const
+{
+    if (row < 0 || row >= rowCount()) {
+        return QString();
+    }
+    return lineText(m_filtering ? m_matchedLines.at(row) : row);
+}
+
+int LogFileModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_filtering ? m_matchedLines.size() : m_lineStarts.size();
+}
+
+QVariant LogFileModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    return rowText(index.row());
+}
+
+void LogFileModel::onFilterFinished()
+{
+    if (m_filterWatcher.isCanceled()) {
+        return;
+    }
+
+    QVector<int> matched = m_filterWatcher.result();
+    if (!matched.isEmpty()) {
+        beginInsertRows(QModelIndex(), 0, matched.size() - 1);
+        m_matchedLines = matched;
+        endInsertRows();
+    }
+
+    // 过滤期间追加的行
+    matchNewLines();
+
+    emit filterFinished(m_matchedLines.size());
+}
+
+bool LogFileModel::remap(qint64 size)
+{
+    // 文件增长后旧映射不覆盖新内容，需要重新映射
+    uchar *data = m_file.map(0, size);
+    if (!data) {
+        return false;
+    }
+    if (m_data) {
+        m_file.unmap(m_data);
+    }
+    m_data = data;
+    return true;
+}
+
+void LogFileModel::indexAppended(qint64 from, qint64 to)
+{
+    const char *base = reinterpret_cast<const char *>(m_data);
+
+    // 上次以换行结尾（或文件原本为空），新内容开启新的一行
+    if (to > from && (from == 0 || m_endsWithNewline)) {
+        m_lineStarts.append(from);
+    }
+
+    qint64 pos = from;
+    while (pos < to) {
+        const void *hit = std::memchr(base + pos, '\n', static_cast<size_t>(to - pos));
+        if (!hit) {
+            break;
+        }
+        qint64 newline = static_cast<const char *>(hit) - base;
+        if (newline + 1 < to) {
+            m_lineStarts.append(newline + 1);
+        }
+        pos = newline + 1;
+    }
+
+    m_size = to;
+    m_endsWithNewline = to > 0 && base[to - 1] == '\n';
+}
+
+QString LogFileModel::lineText(int line) const
+{
+    if (!m_data || line < 0 || line >= m_lineStarts.size()) {
+        return QString();
+    }
+    qint64 end = line + 1 < m_lineStarts.size() ? m_lineStarts.at(line + 1) : m_size;
+    return decodeLine(m_data, m_lineStarts.at(line), end);
+}
+
+int LogFileModel::completeLineCount() const
+{
+    if (m_endsWithNewline) {
+        return m_lineStarts.size();
+    }
+    return qMax(0, m_lineStarts.size() - 1);
+}
+
+void LogFileModel::matchNewLines()
+{
+    // 全量过滤还没返回时由onFilterFinished()接着处理
+    if (!m_filtering || m_filterWatcher.isRunning()) {
+        return;
+    }
+
+    int complete = completeLineCount();
+    QVector<int> matched;
+    for (int line = m_checkedLines; line < complete; ++line) {
+        if (m_filter.match(lineText(line)).hasMatch()) {
+            matched.append(line);
+        }
+    }
+    m_checkedLines = complete;
+
+    if (!matched.isEmpty()) {
+        int first = m_matchedLines.size();
+        beginInsertRows(QModelIndex(), first, first + matched.size() - 1);
+        m_matchedLines += matched;
+        endInsertRows();
+    }
+}
+
+void LogFileModel::matchLines(QPromise<QVector<int>> &promise, const QString &filePath,
+                              const QVector<qint64> &lineStarts, int lineCount, qint64 size,
+                              const QRegularExpression &filter)
+{
+    QVector<int> matched;
+
+    QFile file(filePath);
+    uchar *data = nullptr;
+    if (size > 0 && file.open(QIODevice::ReadOnly) && file.size() >= size) {
+        data = file.map(0, size);
+    }
+    if (!data) {
+        promise.addResult(matched);
+        return;
+    }
+
+    for (int line = 0; line < lineCount; ++line) {
+        if ((line & 0xFFF) == 0 && promise.isCanceled()) {
+            break;
+        }
+        qint64 end = line + 1 < lineStarts.size() ? lineStarts.at(line + 1) : size;
+        if (filter.match(decodeLine(data, lineStarts.at(line), end)).hasMatch()) {
+            matched.append(line);
+        }
+    }
+
+    file.unmap(data);
+    promise.addResult(matched);
+}
@@ -0,0 +1,79 @@
+#ifndef LOGFILEMODEL_H
+#define LOGFILEMODEL_H
+
+#include <QAbstractListModel>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QPromise>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 日志文件列表模型
+ * 将日志文件映射到内存并维护每行的起始偏移，视图只取可见行的文本
+ *
+ * - refresh()只索引上次之后追加的字节，文件变短（被清空或轮转）时重新索引
+ * - 正则过滤在工作线程中对整个索引进行，结果返回前显示为空；
+ *   之后追加的完整行在refresh()中直接匹配
+ * - 末尾没有换行的行会随追加内容更新，过滤模式下等它写完整后才参与匹配
+ */
+class LogFileModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit LogFileModel(QObject *parent = nullptr);
+    ~LogFileModel();
+
+    // 打开并索引整个文件
+    bool openFile(const QString &filePath, QString *error = nullptr);
+    void close();
+
+    QString filePath() const;
+    qint64 indexedSize() const;
+    int lineCount() const;
+
+    // 读取追加的内容，返回是否有变化
+    bool refresh();
+
+    // 设置过滤条件，空表达式表示不过滤
+    void setFilter(const QRegularExpression &filter);
+    bool isFiltering() const;
+    bool isFilterPending() const;
+
+    // 当前显示的第row行的文本
+    QString rowText(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+signals:
+    void filterFinished(int matchedLines);
+
+private:
+    void onFilterFinished();
+    bool remap(qint64 size);
+    void indexAppended(qint64 from, qint64 to);
+    QString lineText(int line) const;
+    int completeLineCount() const;
+    void matchNewLines();
+
+    static void matchLines(QPromise<QVector<int>> &promise, const QString &filePath,
+                           const QVector<qint64> &lineStarts, int lineCount, qint64 size,
+                           const QRegularExpression &filter);
+
+    QFile m_file;
+    uchar *m_data;
+    qint64 m_size;                  // 已映射并索引的字节数
+    QVector<qint64> m_lineStarts;   // 每行起始偏移
+    bool m_endsWithNewline;
+
+    QRegularExpression m_filter;
+    bool m_filtering;
+    QVector<int> m_matchedLines;    // 过滤模式下显示的行号
+    int m_checkedLines;             // 已参与匹配的完整行数
+    QFutureWatcher<QVector<int>> m_filterWatcher;
+};
+
+#endif // LOGFILEMODEL_H
@@ -9,7 +9,11 @@
 
 LogViewer::LogViewer(QWidget *parent)
     : QDialog(parent)
-    , m_logDisplay(nullptr)
+    , m_displayStack(nullptr)
+    , m_hintDisplay(nullptr)
+    , m_logView(nullptr)
+    , m_logModel(new LogFileModel(this))
+    , m_filterEdit(nullptr)
     , m_openLogButton(nullptr)
     , m_refreshButton(nullptr)
     , m_clearButton(nullptr)
@@ -19,6 +23,8 @@ LogViewer::LogViewer(QWidget *parent)
     , m_logPathLabel(nullptr)
     , m_statusLabel(nullptr)
     , m_autoRefreshTimer(new QTimer(this))
+    , m_filterTimer(new QTimer(this))
+    , m_fileWatcher(new QFileSystemWatcher(this))
 {
     setWindowTitle("日志查看器 - B站缓存合并工具");
     setMinimumSize(800, 600);
@@ -32,13 +38,20 @@ LogViewer::LogViewer(QWidget *parent)
 
     createLogContent();
 
-    // 连接自动刷新定时器
-    connect(m_autoRefreshTimer, &QTimer::timeout, this, [this]() {
-        if (!m_currentLogPath.isEmpty() && QFile::exists(m_currentLogPath)) {
-            loadLogFile(m_currentLogPath);
+    // 自动刷新：文件变化时立即读取追加内容，定时器兜底（文件监视在部分文件系统上不可靠）
+    connect(m_autoRefreshTimer, &QTimer::timeout, this, &LogViewer::refreshLogFile);
+    connect(m_fileWatcher, &QFileSystemWatcher::fileChanged, this, [this]() {
+        if (m_autoRefreshCheck->isChecked()) {
+            refreshLogFile();
         }
     });
 
+    // 输入停顿后再过滤
+    m_filterTimer->setSingleShot(true);
+    m_filterTimer->setInterval(300);
+    connect(m_filterTimer, &QTimer::timeout, this, &LogViewer::onFilterChanged);
+    connect(m_logModel, &LogFileModel::filterFinished, this, &LogViewer::updateStatus);
+
     // 默认加载最近的日志
     QString defaultLogPath = getDefaultLogPath();
     if (!defaultLogPath.isEmpty()) {
@@ -95,11 +108,17 @@ void LogViewer::createLogContent()
     m_autoRefreshCheck = new QCheckBox("自动刷新", this);
     m_autoRefreshCheck->setChecked(false);
 
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText("过滤（正则表达式）");
+    m_filterEdit->setClearButtonEnabled(true);
+    m_filterEdit->setMinimumWidth(200);
+
     m_controlLayout->addWidget(m_openLogButton);
     m_controlLayout->addWidget(m_refreshButton);
     m_controlLayout->addWidget(m_clearButton);
     m_controlLayout->addWidget(m_exportButton);
     m_controlLayout->addStretch();
+    m_controlLayout->addWidget(m_filterEdit);
     m_controlLayout->addWidget(m_autoRefreshCheck);
 
     m_mainLayout->addLayout(m_controlLayout);
@@ -130,9 +149,9 @@ void LogViewer::createLogContent()
     m_mainLayout->addLayout(statusLayout);
 
     // 日志显示区域
-    m_logDisplay = new QPlainTextEdit(this);
-    m_logDisplay->setReadOnly(true);
-    m_logDisplay->setStyleSheet(
+    m_hintDisplay = new QPlainTextEdit(this);
+    m_hintDisplay->setReadOnly(true);
+    m_hintDisplay->setStyleSheet(
         "QPlainTextEdit {"
         "    border: 1px solid #ddd;"
         "    border-radius: 4px;"
@@ -142,7 +161,7 @@ void LogViewer::createLogContent()
         "    padding: 8px;"
         "}"
     );
-    m_logDisplay->setPlainText(
+    m_hintDisplay->setPlainText(
         "=== 日志查看器 ===\n"
         "\n"
         "欢迎使用日志查看器！\n"
@@ -157,7 +176,29 @@ void LogViewer::createLogContent()
         "提示：主程序的日志会实时显示在这里\n"
     );
 
-    m_mainLayout->addWidget(m_logDisplay, 1);
+    // 行数很多时只有可见行会被取出和绘制
+    m_logView = new QListView(this);
+    m_logView->setModel(m_logModel);
+    m_logView->setUniformItemSizes(true);
+    m_logView->setWordWrap(false);
+    m_logView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_logView->setStyleSheet(
+        "QListView {"
+        "    border: 1px solid #ddd;"
+        "    border-radius: 4px;"
+        "    background-color: #fafafa;"
+        "    font-family: 'Consolas', 'Courier New', monospace;"
+        "    font-size: 12px;"
+        "    padding: 8px;"
+        "}"
+    );
+
+    m_displayStack = new QStackedWidget(this);
+    m_displayStack->addWidget(m_hintDisplay);
+    m_displayStack->addWidget(m_logView);
+    m_displayStack->setCurrentWidget(m_hintDisplay);
+
+    m_mainLayout->addWidget(m_displayStack, 1);
 
     // 关闭按钮
     QHBoxLayout *buttonLayout = new QHBoxLayout();
@@ -175,6 +216,7 @@ void LogViewer::createLogContent()
     connect(m_exportButton, &QPushButton::clicked, this, &LogViewer::onExportClicked);
     connect(m_closeButton, &QPushButton::clicked, this, &QDialog::accept);
     connect(m_autoRefreshCheck, &QCheckBox::toggled, this, &LogViewer::onAutoRefreshToggled);
+    connect(m_filterEdit, &QLineEdit::textChanged, m_filterTimer, qOverload<>(&QTimer::start));
 }
 
 void LogViewer::onOpenLogClicked()
@@ -200,13 +242,14 @@ void LogViewer::onRefreshClicked()
 
 void LogViewer::onClearClicked()
 {
-    m_logDisplay->clear();
+    // 只清空显示，点击刷新会重新加载
+    m_logModel->close();
     m_statusLabel->setText("日志已清空");
 }
 
 void LogViewer::onExportClicked()
 {
-    if (m_logDisplay->toPlainText().isEmpty()) {
+    if (m_logModel->rowCount() == 0) {
         QMessageBox::warning(this, "警告", "没有可导出的日志内容！");
         return;
     }
@@ -219,12 +262,24 @@ void LogViewer::onExportClicked()
     );
 
     if (!exportPath.isEmpty()) {
-        QFile file(exportPath);
-        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            QTextStream stream(&file);
-            stream << m_logDisplay->toPlainText();
-            file.close();
+        bool exported = false;
+        if (!m_logModel->isFiltering()) {
+            // 未过滤时直接复制文件，不经过内存
+            QFile::remove(exportPath);
+            exported = QFile::copy(m_logModel->filePath(), exportPath);
+        } else {
+            QFile file(exportPath);
+            if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+                QTextStream stream(&file);
+                for (int row = 0; row < m_logModel->rowCount(); ++row) {
+                    stream << m_logModel->rowText(row) << "\n";
+                }
+                file.close();
+                exported = true;
+            }
+        }
 
+        if (exported) {
             QMessageBox::information(
                 this,
                 "成功",
@@ -252,35 +307,87 @@ void LogViewer::loadLogFile(const QString &filePath)
     m_currentLogPath = filePath;
     m_logPathLabel->setText(QString("日志文件: %1").arg(filePath));
 
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        m_logDisplay->setPlainText(QString("错误：无法打开文件 %1").arg(filePath));
+    if (!m_fileWatcher->files().isEmpty()) {
+        m_fileWatcher->removePaths(m_fileWatcher->files());
+    }
+
+    QString error;
+    if (!m_logModel->openFile(filePath, &error)) {
+        showHint(QString("错误：无法打开文件 %1\n%2").arg(filePath, error));
         m_statusLabel->setText("文件读取失败");
         return;
     }
 
-    QTextStream stream(&file);
-    QString content = stream.readAll();
-    file.close();
+    m_fileWatcher->addPath(filePath);
+    m_displayStack->setCurrentWidget(m_logView);
+    m_logView->scrollToBottom();
+    updateStatus();
+}
+
+void LogViewer::refreshLogFile()
+{
+    if (m_currentLogPath.isEmpty() || !QFile::exists(m_currentLogPath)) {
+        return;
+    }
+
+    // 文件被替换后监视会失效，重新加上
+    if (!m_fileWatcher->files().contains(m_currentLogPath)) {
+        m_fileWatcher->addPath(m_currentLogPath);
+    }
+
+    QScrollBar *scrollBar = m_logView->verticalScrollBar();
+    bool following = scrollBar->value() == scrollBar->maximum();
 
-    // 保存当前滚动位置
-    int previousScroll = m_logDisplay->verticalScrollBar()->value();
-    bool atBottom = (previousScroll == m_logDisplay->verticalScrollBar()->maximum());
+    // 只读取追加的部分
+    if (m_logModel->refresh()) {
+        scrollToEndIfFollowing(following);
+        updateStatus();
+    }
+}
 
-    // 设置内容
-    m_logDisplay->setPlainText(content);
+void LogViewer::scrollToEndIfFollowing(bool following)
+{
+    // 之前停在底部时跟随新内容，否则保持用户的位置
+    if (following) {
+        m_logView->scrollToBottom();
+    }
+}
+
+void LogViewer::onFilterChanged()
+{
+    QString pattern = m_filterEdit->text();
+    QRegularExpression filter(pattern);
+    if (!pattern.isEmpty() && !filter.isValid()) {
+        m_statusLabel->setText(QString("过滤表达式无效: %1").arg(filter.errorString()));
+        return;
+    }
+
+    m_logModel->setFilter(filter);
+    updateStatus();
+}
+
+void LogViewer::showHint(const QString &text)
+{
+    m_hintDisplay->setPlainText(text);
+    m_displayStack->setCurrentWidget(m_hintDisplay);
+}
+
+void LogViewer::updateStatus()
+{
+    if (m_currentLogPath.isEmpty()) {
+        return;
+    }
 
-    // 自动滚动到底部（如果之前在底部）
-    if (atBottom) {
-        m_logDisplay->verticalScrollBar()->setValue(
-            m_logDisplay->verticalScrollBar()->maximum()
-        );
+    QString lineInfo;
+    if (m_logModel->isFilterPending()) {
+        lineInfo = "正在过滤...";
+    } else if (m_logModel->isFiltering()) {
+        lineInfo = QString("匹配: %1/%2 行").arg(m_logModel->rowCount()).arg(m_logModel->lineCount());
     } else {
-        m_logDisplay->verticalScrollBar()->setValue(previousScroll);
+        lineInfo = QString("行数: %1").arg(m_logModel->lineCount());
     }
 
-    // 更新状态
-    QFileInfo fileInfo(filePath);
+    QFileInfo fileInfo(m_currentLogPath);
     QString sizeStr;
     if (fileInfo.size() < 1024) {
         sizeStr = QString::number(fileInfo.size()) + " B";
@@ -291,7 +398,8 @@ void LogViewer::loadLogFile(const QString &filePath)
     }
 
     m_statusLabel->setText(
-        QString("大小: %1, 修改时间: %2")
+        QString("%1, 大小: %2, 修改时间: %3")
+        .arg(lineInfo)
         .arg(sizeStr)
         .arg(fileInfo.lastModified().toString("yyyy-MM-dd hh:mm:ss"))
     );
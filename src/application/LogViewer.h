@@ -12,11 +12,16 @@
 #include <QTextStream>
 #include <QString>
 #include <QPlainTextEdit>
+#include <QListView>
+#include <QLineEdit>
+#include <QStackedWidget>
+#include <QFileSystemWatcher>
 #include <QLabel>
 #include <QCheckBox>
 #include <QComboBox>
 #include <QApplication>
 #include <QTimer>
+#include "LogFileModel.h"
 
 class LogViewer : public QDialog
 {
@@ -32,9 +37,14 @@ private slots:
     void onClearClicked();
     void onExportClicked();
     void onAutoRefreshToggled(bool checked);
+    void onFilterChanged();
 
 private:
     void loadLogFile(const QString &filePath);
+    void refreshLogFile();
+    void scrollToEndIfFollowing(bool following);
+    void updateStatus();
+    void showHint(const QString &text);
     void createLogContent();
     QString getDefaultLogPath();
     bool openWithSystemApp(const QString &filePath);
@@ -42,7 +52,11 @@ private:
     // UI组件
     QVBoxLayout *m_mainLayout;
     QHBoxLayout *m_controlLayout;
-    QPlainTextEdit *m_logDisplay;
+    QStackedWidget *m_displayStack;
+    QPlainTextEdit *m_hintDisplay;      // 未加载或加载失败时的提示
+    QListView *m_logView;               // 只绘制可见行
+    LogFileModel *m_logModel;
+    QLineEdit *m_filterEdit;
     QPushButton *m_openLogButton;
     QPushButton *m_refreshButton;
     QPushButton *m_clearButton;
@@ -55,6 +69,8 @@ private:
     // 数据
     QString m_currentLogPath;
     QTimer *m_autoRefreshTimer;
+    QTimer *m_filterTimer;
+    QFileSystemWatcher *m_fileWatcher;
 };
 
 #endif // LOGVIEWER_H
@@ -12,6 +12,13 @@
 #include <QApplication>
 #include <QStyle>
 #include <QTimer>
+#include <QThread>
+
+namespace {
+const int kDrainIntervalMs = 33;        // 约30帧每秒
+const int kMaxLinesPerFrame = 500;      // 每帧最多追加的日志行数
+const int kMaxLogBlocks = 20000;        // 日志框保留的最大行数
+}
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -20,7 +27,14 @@ MainWindow::MainWindow(QWidget *parent)
     , patternManager(nullptr)
     , fileScanner(nullptr)
     , m_isMerging(false)
+    , m_drainTimer(new QTimer(this))
+    , m_drainScheduled(false)
+    , m_logSink(nullptr)
 {
+    m_drainTimer->setSingleShot(true);
+    m_drainTimer->setInterval(kDrainIntervalMs);
+    connect(m_drainTimer, &QTimer::timeout, this, &MainWindow::drainLogs);
+
     // 设置窗口属性
     setWindowTitle(tr("Qt B站缓存合并工具"));
     setMinimumSize(900, 700);
@@ -65,6 +79,11 @@ MainWindow::~MainWindow()
 {
 }
 
+void MainWindow::setLogSink(LogFileSink *sink)
+{
+    m_logSink = sink;
+}
+
 void MainWindow::setDirectoryPath(const QString &path)
 {
     dirPathText->setPlainText(path);
@@ -322,6 +341,8 @@ void MainWindow::createCentralWidget()
         "}"
     );
     loggerTextEdit->setMinimumHeight(200);
+    // 超出上限时丢弃最早的行，长时间运行后排版开销不再增长
+    loggerTextEdit->document()->setMaximumBlockCount(kMaxLogBlocks);
 
     logLayout->addWidget(logTitle);
     logLayout->addWidget(loggerTextEdit);
@@ -468,17 +489,17 @@ void MainWindow::setupConnections()
 
     // FileScanner信号连接
     if (fileScanner) {
+        // 高频信号直接写入队列，不逐条排队到界面线程
         connect(fileScanner, &FileScanner::scanProgress, this,
                 [this](int current, int total) {
-                    progressBar->setMaximum(total);
-                    progressBar->setValue(current);
-                    statusBar()->showMessage(tr("扫描进度: %1/%2").arg(current).arg(total));
-                });
+                    m_scanProgress.store(current, total);
+                    scheduleDrain();
+                }, Qt::DirectConnection);
 
         connect(fileScanner, &FileScanner::scanLog, this,
                 [this](const QString& message) {
-                    appendLog(message);
-                });
+                    postLog(message);
+                }, Qt::DirectConnection);
 
         connect(fileScanner, &FileScanner::scanError, this,
                 [this](const QString& error) {
@@ -489,6 +510,7 @@ void MainWindow::setupConnections()
         // 统一的scanCompleted处理，根据标志位决定操作
         connect(fileScanner, &FileScanner::scanCompleted, this,
                 [this](bool success) {
+                    m_scanProgress.clear();
                     progressBar->reset();
                     statusBar()->clearMessage();
                     if (success) {
@@ -516,8 +538,9 @@ void MainWindow::initializeCoreComponents()
     // 创建模式管理器
     patternManager = new PatternManager(configManager, this);
 
-    // 创建文件扫描器
+    // 创建文件扫描器，与合并共用媒体信息缓存：扫描时探测过的文件合并时不再启动ffprobe
     fileScanner = new FileScanner(configManager, patternManager, this);
+    fileScanner->setMediaInfoCache(ffmpegManager->mediaInfo());
 }
 
 void MainWindow::loadConfig()
@@ -541,11 +564,68 @@ void MainWindow::saveConfig()
 
 void MainWindow::appendLog(const QString &message)
 {
-    if (loggerTextEdit) {
-        loggerTextEdit->append(message);
+    postLog(message);
+}
+
+void MainWindow::postLog(const QString &message)
+{
+    if (m_logSink) {
+        m_logSink->write(message);
+    }
+
+    if (QThread::currentThread() != thread()) {
+        m_logRing.push(message);
+    } else if (!m_logRing.tryPush(message)) {
+        // 界面线程自己在长时间同步处理（扫描、合并），等不到定时器，就地清空队列后再写入，这条不算丢弃
+        drainLogs();
+        m_logRing.push(message);
+    }
+    scheduleDrain();
+}
+
+void MainWindow::scheduleDrain()
+{
+    if (m_drainScheduled.exchange(true)) {
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this]() {
+        m_drainTimer->start();
+    }, Qt::QueuedConnection);
+}
+
+void MainWindow::drainLogs()
+{
+    // 先清标志，取出期间写入的新内容会重新排期
+    m_drainScheduled.store(false);
+
+    int current = 0;
+    int total = 0;
+    if (m_scanProgress.take(current, total)) {
+        progressBar->setMaximum(total);
+        progressBar->setValue(current);
+        statusBar()->showMessage(tr("扫描进度: %1/%2").arg(current).arg(total));
+    }
+    if (m_mergeProgress.take(current, total)) {
+        progressBar->setValue(current);
+    }
+
+    QStringList lines;
+    m_logRing.drain(lines, kMaxLinesPerFrame);
+    quint64 dropped = m_logRing.takeDropped();
+    if (dropped > 0) {
+        lines.append(tr("[WARNING] 日志过多，已省略 %1 条").arg(dropped));
+    }
+
+    if (!lines.isEmpty() && loggerTextEdit) {
+        // 一帧的日志一次追加，只触发一次排版和滚动
+        loggerTextEdit->append(lines.join('\n'));
         loggerTextEdit->verticalScrollBar()->setValue(
             loggerTextEdit->verticalScrollBar()->maximum());
     }
+
+    if (!m_logRing.isEmpty()) {
+        scheduleDrain();
+    }
 }
 
 void MainWindow::onStartClicked()
@@ -743,7 +823,7 @@ void MainWindow::startMergeAfterScan()
 {
     appendLog(tr("[INFO] 扫描完成，开始合并操作"));
 
-    QList<FileScanner::VideoGroup> videoGroups = fileScanner->videoGroups();
+    const QList<FileScanner::VideoGroup> &videoGroups = fileScanner->videoGroups();
     if (videoGroups.isEmpty()) {
         appendLog(tr("[ERROR] 没有找到可合并的视频组"));
         QMessageBox::warning(this, tr("警告"), tr("未找到可合并的视频文件"));
@@ -758,18 +838,19 @@ void MainWindow::startMergeAfterScan()
     // 连接FFmpeg信号
     connect(ffmpegManager, &FfmpegManager::ffmpegOutput, this,
             [this](const QString& output) {
-                appendLog(tr("[FFmpeg] %1").arg(output));
-            });
+                postLog(tr("[FFmpeg] %1").arg(output));
+            }, Qt::DirectConnection);
 
     connect(ffmpegManager, &FfmpegManager::ffmpegError, this,
             [this](const QString& error) {
-                appendLog(tr("[FFmpeg Error] %1").arg(error));
-            });
+                postLog(tr("[FFmpeg Error] %1").arg(error));
+            }, Qt::DirectConnection);
 
     connect(ffmpegManager, &FfmpegManager::progressUpdated, this,
             [this](double progress) {
-                progressBar->setValue(static_cast<int>(progress));
-            });
+                m_mergeProgress.store(static_cast<int>(progress), 100);
+                scheduleDrain();
+            }, Qt::DirectConnection);
 
     connect(ffmpegManager, &FfmpegManager::ffmpegFinished, this,
             [this](bool success) {
@@ -787,8 +868,7 @@ void MainWindow::startMergeAfterScan()
             });
 
     // 开始合并第一个视频组
-    FileScanner::VideoGroup firstGroup = videoGroups.first();
-    mergeVideoGroup(firstGroup);
+    mergeVideoGroup(videoGroups.first());
 }
 
 void MainWindow::startMergeOperation()
@@ -835,7 +915,7 @@ void MainWindow::startMergeOperation()
             [this](bool success) {
                 if (success) {
                     // 扫描成功，开始合并
-                    QList<FileScanner::VideoGroup> videoGroups = fileScanner->videoGroups();
+                    const QList<FileScanner::VideoGroup> &videoGroups = fileScanner->videoGroups();
                     if (videoGroups.isEmpty()) {
                         appendLog(tr("[ERROR] 没有找到可合并的视频组"));
                         QMessageBox::warning(this, tr("警告"), tr("未找到可合并的视频文件"));
@@ -879,8 +959,7 @@ void MainWindow::startMergeOperation()
                             });
 
                     // 开始合并第一个视频组
-                    FileScanner::VideoGroup firstGroup = videoGroups.first();
-                    mergeVideoGroup(firstGroup);
+                    mergeVideoGroup(videoGroups.first());
                 } else {
                     appendLog(tr("[ERROR] 扫描失败，无法合并"));
                     QMessageBox::critical(this, tr("错误"), tr("扫描失败，请检查目录格式"));
@@ -905,7 +984,7 @@ void MainWindow::mergeVideoGroup(const FileScanner::VideoGroup& videoGroup)
     for (const FileScanner::VideoFile& videoFile : videoGroup.files) {
         appendLog(tr("[INFO] 合并文件: %1").arg(videoFile.entryPath));
 
-        QString title = videoFile.metadata.value("title", "unknown").toString();
+        QString title = videoFile.metadata.title.isEmpty() ? QStringLiteral("unknown") : videoFile.metadata.title;
         QString outputFile = QDir(outputDir).filePath(QString("%1.mp4").arg(title));
 
         double progress = 0.0;
@@ -927,6 +1006,9 @@ void MainWindow::mergeVideoGroup(const FileScanner::VideoGroup& videoGroup)
                     tr("合并过程中遇到错误：\n%1\n\n已合并 %2 个文件，失败 %3 个文件")
                     .arg(videoFile.entryPath).arg(successCount).arg(errorCount));
                 m_isMerging = false;
+                if (configManager) {
+                    configManager->flushStats();
+                }
                 return;
             } else {
                 appendLog(tr("[WARNING] 错误跳过已启用，继续处理下一个文件"));
@@ -947,6 +1029,11 @@ void MainWindow::mergeVideoGroup(const FileScanner::VideoGroup& videoGroup)
         }
     }
 
+    // 本组的统计一次性写盘
+    if (configManager) {
+        configManager->flushStats();
+    }
+
     // 合并完成，统计结果
     if (errorCount > 0) {
         appendLog(tr("[WARNING] 视频组处理完成 - 成功: %1, 失败: %2")
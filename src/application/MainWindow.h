@@ -28,6 +28,9 @@
 #include "core/FfmpegManager.h"
 #include "core/PatternManager.h"
 #include "core/FileScanner.h"
+#include "core/LogRing.h"
+#include "core/LogFileSink.h"
+#include <atomic>
 
 /**
  * @brief Qt版本的BiliCacheMerge主窗口
@@ -48,6 +51,7 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
     void setDirectoryPath(const QString &path);
+    void setLogSink(LogFileSink *sink);     // 日志同时写入文件
 
 private slots:
     // 菜单事件处理
@@ -90,6 +94,9 @@ private:
     void loadConfig();
     void saveConfig();
     void appendLog(const QString &message);
+    void postLog(const QString &message);   // 任意线程调用，写入日志队列
+    void scheduleDrain();
+    void drainLogs();                        // 界面线程按帧取出日志和进度
     void startMergeOperation();
     void mergeVideoGroup(const FileScanner::VideoGroup& videoGroup);
 
@@ -114,6 +121,14 @@ private:
     // 状态标志
     bool m_isMerging;                // 是否处于合并状态
 
+    // 工作线程到界面的日志和进度，由m_drainTimer按帧合并显示
+    LogRing m_logRing;
+    LatestProgress m_scanProgress;
+    LatestProgress m_mergeProgress;
+    QTimer* m_drainTimer;
+    std::atomic<bool> m_drainScheduled;
+    LogFileSink* m_logSink;
+
     // 核心组件
     ConfigManager* configManager;
     FfmpegManager* ffmpegManager;
@@ -0,0 +1,283 @@
+#include "BatchRunner.h"
+#include "core/ConfigManager.h"
+#include "core/FfmpegManager.h"
+#include "core/PatternManager.h"
+#include "core/DanmakuConverter.h"
+#include "core/MergeThread.h"
+#include "core/LogFileSink.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFileInfo>
+#include <QEventLoop>
+#include <QTimer>
+#include <QTextStream>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// 信号处理函数中只能设置标志，由事件循环中的定时器转为stop()调用
+std::atomic<bool> g_interruptRequested(false);
+
+void onTerminateSignal(int)
+{
+    g_interruptRequested.store(true);
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(QObject *parent)
+    : QObject(parent)
+    , m_quiet(false)
+    , m_logSink(nullptr)
+{
+}
+
+BatchRunner::~BatchRunner()
+{
+}
+
+bool BatchRunner::isBatchRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--batch") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int BatchRunner::run(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("B站缓存合并工具（命令行批处理模式）");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("input", "B站缓存目录");
+
+    QCommandLineOption batchOption("batch", "以命令行批处理模式运行（不显示窗口）");
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+                                    "输出目录（默认: <缓存目录>/merged）", "dir");
+    QCommandLineOption patternOption(QStringList() << "p" << "pattern",
+                                     "只使用指定名称的模式（默认: 尝试全部模式）", "name");
+    QCommandLineOption concurrencyOption(QStringList() << "j" << "concurrency",
+                                         "同时进行的合并任务数（默认: 2）", "n", "2");
+    QCommandLineOption deviceStreamsOption("device-streams",
+                                           "输入输出在不同磁盘上时，每块磁盘同时进行的合并任务数（默认: 2）", "n", "2");
+    QCommandLineOption smallBatchOption("small-batch",
+                                        "小文件批量合并时每次FFmpeg调用处理的最多文件数（默认: 8，1为不批量）", "n", "8");
+    QCommandLineOption danmakuOption("danmaku", "将弹幕转换为ASS字幕");
+    QCommandLineOption coverOption("cover", "保存封面");
+    QCommandLineOption subtitleOption("subtitle", "下载CC字幕");
+    QCommandLineOption oneDirOption("one-dir", "所有文件输出到同一目录，不按视频组分目录");
+    QCommandLineOption orderedOption("ordered", "文件名前加分P编号");
+    QCommandLineOption overwriteOption("overwrite", "覆盖已存在的同名文件");
+    QCommandLineOption errorSkipOption("error-skip", "单个文件失败时继续合并其余文件");
+    QCommandLineOption stallOption("stall-timeout", "FFmpeg无进度超过此秒数视为卡死并终止（默认: 120，0为不检测）",
+                                   "seconds", "120");
+    QCommandLineOption noProbeOption("no-probe", "扫描时不用ffprobe检查媒体文件（更快，但发现不了下载不完整的文件）");
+    QCommandLineOption repairJsonOption("repair-json", "把自动修复的损坏entry文件写回磁盘（先写临时文件再替换）");
+    QCommandLineOption traceOption("trace", "将各阶段耗时导出为Chrome trace JSON", "file");
+    QCommandLineOption metricsOption("metrics", "定期写入Prometheus指标文件（供node_exporter textfile收集，扩展名需为.prom）", "file");
+    QCommandLineOption logFileOption("log-file", "同时写入日志文件（后台写入，按大小和时间轮转并压缩旧文件）", "file");
+    QCommandLineOption quietOption(QStringList() << "q" << "quiet", "只输出错误信息");
+
+    parser.addOptions({batchOption, outputOption, patternOption, concurrencyOption, deviceStreamsOption, smallBatchOption,
+                       danmakuOption, coverOption, subtitleOption, oneDirOption,
+                       orderedOption, overwriteOption, errorSkipOption, stallOption, noProbeOption, repairJsonOption, traceOption, metricsOption, logFileOption, quietOption});
+
+    if (!parser.parse(arguments)) {
+        printLine(parser.errorText(), true);
+        return ExitUsageError;
+    }
+    if (parser.isSet("help")) {
+        printLine(parser.helpText());
+        return ExitSuccess;
+    }
+    if (parser.isSet("version")) {
+        printLine(QString("%1 %2").arg(QCoreApplication::applicationName(),
+                                       QCoreApplication::applicationVersion()));
+        return ExitSuccess;
+    }
+
+    m_quiet = parser.isSet(quietOption);
+
+    const QStringList positional = parser.positionalArguments();
+    if (positional.size() != 1) {
+        printLine("需要且只能指定一个缓存目录", true);
+        printLine(parser.helpText(), true);
+        return ExitUsageError;
+    }
+
+    bool ok = false;
+    int concurrency = parser.value(concurrencyOption).toInt(&ok);
+    if (!ok || concurrency < 1) {
+        printLine(QString("无效的并发数: %1").arg(parser.value(concurrencyOption)), true);
+        return ExitUsageError;
+    }
+
+    int deviceStreams = parser.value(deviceStreamsOption).toInt(&ok);
+    if (!ok || deviceStreams < 1) {
+        printLine(QString("无效的每盘任务数: %1").arg(parser.value(deviceStreamsOption)), true);
+        return ExitUsageError;
+    }
+
+    int smallBatch = parser.value(smallBatchOption).toInt(&ok);
+    if (!ok || smallBatch < 1) {
+        printLine(QString("无效的批量文件数: %1").arg(parser.value(smallBatchOption)), true);
+        return ExitUsageError;
+    }
+
+    int stallSeconds = parser.value(stallOption).toInt(&ok);
+    if (!ok || stallSeconds < 0) {
+        printLine(QString("无效的卡死检测时间: %1").arg(parser.value(stallOption)), true);
+        return ExitUsageError;
+    }
+
+    // 日志文件在后台线程写入，磁盘慢时也不会拖住合并
+    if (parser.isSet(logFileOption) && !m_logSink) {
+        m_logSink = new LogFileSink(this);
+        m_logSink->setFilePath(QFileInfo(parser.value(logFileOption)).absoluteFilePath());
+        m_logSink->start();
+        m_logSink->installMessageHandler();
+    }
+
+    QString inputPath = QDir(positional.first()).absolutePath();
+    if (!QFileInfo(inputPath).isDir()) {
+        printLine(QString("目录不存在: %1").arg(inputPath), true);
+        return ExitSetupError;
+    }
+
+    QString outputPath = parser.isSet(outputOption)
+        ? QDir(parser.value(outputOption)).absolutePath()
+        : QDir(inputPath).filePath("merged");
+    if (!QDir().mkpath(outputPath)) {
+        printLine(QString("无法创建输出目录: %1").arg(outputPath), true);
+        return ExitSetupError;
+    }
+
+    // 与图形界面共用配置文件中的FFmpeg和模式文件路径
+    ConfigManager configManager;
+    configManager.loadConfig();
+
+    FfmpegManager ffmpegManager(&configManager);
+    if (!ffmpegManager.isValidFfmpegPath()) {
+        printLine(QString("FFmpeg不可用: %1").arg(ffmpegManager.ffmpegPath()), true);
+        return ExitSetupError;
+    }
+
+    PatternManager patternManager(&configManager);
+    DanmakuConverter danmakuConverter;
+
+    MergeThread::MergeConfig config;
+    config.inputPath = inputPath;
+    config.outputPath = outputPath;
+    config.patternName = parser.value(patternOption);
+    config.danmuEnabled = parser.isSet(danmakuOption);
+    config.coverEnabled = parser.isSet(coverOption);
+    config.subtitleEnabled = parser.isSet(subtitleOption);
+    config.oneDir = parser.isSet(oneDirOption);
+    config.ordered = parser.isSet(orderedOption);
+    config.overwrite = parser.isSet(overwriteOption);
+    config.errorSkip = parser.isSet(errorSkipOption);
+    config.concurrency = concurrency;
+    config.streamsPerDevice = deviceStreams;
+    config.batchSize = smallBatch;
+    config.stallTimeoutMs = stallSeconds * 1000;
+    config.probeMedia = !parser.isSet(noProbeOption);
+    config.writeRepairedJson = parser.isSet(repairJsonOption);
+    if (parser.isSet(metricsOption)) {
+        config.metricsPath = QFileInfo(parser.value(metricsOption)).absoluteFilePath();
+    }
+    if (parser.isSet(traceOption)) {
+        config.tracePath = QFileInfo(parser.value(traceOption)).absoluteFilePath();
+    }
+
+    MergeThread mergeThread;
+    mergeThread.setConfig(config);
+    mergeThread.setConfigManager(&configManager);
+    mergeThread.setFfmpegManager(&ffmpegManager);
+    mergeThread.setPatternManager(&patternManager);
+    mergeThread.setDanmakuConverter(&danmakuConverter);
+
+    bool completed = false;
+    int successCount = 0;
+    int failedCount = 0;
+
+    connect(&mergeThread, &MergeThread::logMessage, this, [this](const QString &message) {
+        printLine(message);
+    });
+    connect(&mergeThread, &MergeThread::errorOccurred, this, [this](const QString &error) {
+        printLine(error, true);
+    });
+    connect(&mergeThread, &MergeThread::mergeCompleted, this,
+            [&completed, &successCount, &failedCount](int success, int failed) {
+                completed = true;
+                successCount = success;
+                failedCount = failed;
+            });
+
+    // 收到终止信号时停止派发新任务并中止进行中的合并，下次运行时从合并日志续传
+    installSignalHandlers();
+    bool interrupted = false;
+    QTimer signalTimer;
+    signalTimer.setInterval(200);
+    connect(&signalTimer, &QTimer::timeout, this, [this, &mergeThread, &interrupted]() {
+        if (g_interruptRequested.load() && !interrupted) {
+            interrupted = true;
+            printLine("收到终止信号，正在中止进行中的任务...", true);
+            mergeThread.stop();
+        }
+    });
+    signalTimer.start();
+
+    QEventLoop loop;
+    connect(&mergeThread, &QThread::finished, &loop, &QEventLoop::quit);
+    mergeThread.start();
+    loop.exec();
+
+    // 处理线程结束前排队的信号
+    QCoreApplication::processEvents();
+
+    if (interrupted) {
+        return ExitInterrupted;
+    }
+    if (!completed) {
+        return ExitSetupError;
+    }
+    if (successCount + failedCount == 0) {
+        return ExitNothingToDo;
+    }
+
+    printLine(QString("完成: 成功 %1 个，失败 %2 个").arg(successCount).arg(failedCount));
+    return failedCount > 0 ? ExitPartialFailure : ExitSuccess;
+}
+
+void BatchRunner::printLine(const QString &message, bool isError)
+{
+    // 文件中保留完整日志，不受--quiet影响
+    if (m_logSink) {
+        m_logSink->write(isError ? QString("[ERROR] %1").arg(message) : message);
+    }
+
+    if (m_quiet && !isError) {
+        return;
+    }
+
+    QByteArray data = message.toUtf8();
+    data.append('\n');
+    std::FILE *stream = isError ? stderr : stdout;
+    std::fwrite(data.constData(), 1, static_cast<size_t>(data.size()), stream);
+    std::fflush(stream);
+}
+
+void BatchRunner::installSignalHandlers()
+{
+    g_interruptRequested.store(false);
+    std::signal(SIGINT, onTerminateSignal);
+    std::signal(SIGTERM, onTerminateSignal);
+}
@@ -0,0 +1,49 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class LogFileSink;
+
+/**
+ * @brief 命令行批处理
+ * 不创建任何窗口，直接驱动FileScanner、MergeThread和DanmakuConverter完成合并，
+ * 适合在无图形界面的服务器上由cron等定时调用
+ *
+ * 用法: BiliCacheMerge --batch [选项] <缓存目录>
+ * 退出码见ExitCode，脚本可据此判断结果
+ */
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ExitCode {
+        ExitSuccess = 0,        // 全部合并成功
+        ExitPartialFailure = 1, // 部分文件合并失败
+        ExitUsageError = 2,     // 参数错误
+        ExitSetupError = 3,     // 环境错误：目录不存在、FFmpeg不可用、扫描失败等
+        ExitNothingToDo = 4,    // 未找到可合并的文件
+        ExitInterrupted = 130   // 收到SIGINT/SIGTERM，已完成的任务记入日志，可续传
+    };
+
+    explicit BatchRunner(QObject *parent = nullptr);
+    ~BatchRunner();
+
+    // 解析参数并执行合并，返回退出码（需在QCoreApplication中调用）
+    int run(const QStringList &arguments);
+
+    // 判断是否请求了批处理模式（在创建QApplication之前调用）
+    static bool isBatchRequested(int argc, char *argv[]);
+
+private:
+    void printLine(const QString &message, bool isError = false);
+    static void installSignalHandlers();
+
+    bool m_quiet;
+    LogFileSink *m_logSink;
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,182 @@
+#include "CompiledPattern.h"
+#include <QDir>
+#include <QFileInfo>
+
+namespace {
+
+// 模式文件中未配置的项写作null，转成QString后为空或"null"
+QString templateValue(const QVariantMap &tree, const char *key)
+{
+    QString value = tree.value(QLatin1String(key)).toString();
+    if (value == "null") {
+        return QString();
+    }
+
+    // 统一路径分隔符（在变量替换之前）
+    if (QDir::separator() == '/') {
+        value.replace('\\', '/');
+    } else {
+        value.replace('/', '\\');
+    }
+    return value;
+}
+
+} // namespace
+
+JsonFieldPath JsonFieldPath::parse(const QString &text)
+{
+    JsonFieldPath path;
+    if (text.isEmpty() || text == "null") {
+        return path;
+    }
+    path.text = text;
+    path.keys = text.split('-');
+    return path;
+}
+
+QJsonValue JsonFieldPath::lookup(const QJsonObject &root) const
+{
+    if (keys.isEmpty()) {
+        return QJsonValue(QJsonValue::Undefined);
+    }
+
+    QJsonValue current = root;
+    for (const QString &key : keys) {
+        if (!current.isObject()) {
+            return QJsonValue(QJsonValue::Undefined);
+        }
+        current = current.toObject().value(key);
+    }
+    return current;
+}
+
+PathTemplate PathTemplate::parse(const QString &text, QVector<JsonFieldPath> &fields)
+{
+    PathTemplate result;
+    result.text = text;
+
+    int pos = 0;
+    while (pos < text.size()) {
+        int open = text.indexOf('%', pos);
+        int close = open < 0 ? -1 : text.indexOf('%', open + 1);
+        if (close < 0) {
+            // 剩余部分没有成对的%
+            result.segments.append({Literal, text.mid(pos), -1});
+            break;
+        }
+        if (open > pos) {
+            result.segments.append({Literal, text.mid(pos, open - pos), -1});
+        }
+
+        QString name = text.mid(open + 1, close - open - 1);
+        QString placeholder = text.mid(open, close - open + 1);
+        if (name == "group") {
+            result.segments.append({GroupName, placeholder, -1});
+        } else if (name == "episode") {
+            result.segments.append({EpisodeName, placeholder, -1});
+        } else if (name.isEmpty()) {
+            result.segments.append({Literal, placeholder, -1});
+        } else {
+            int field = -1;
+            for (int i = 0; i < fields.size(); ++i) {
+                if (fields.at(i).text == name) {
+                    field = i;
+                    break;
+                }
+            }
+            if (field < 0) {
+                field = fields.size();
+                fields.append(JsonFieldPath::parse(name));
+            }
+            result.segments.append({Field, placeholder, field});
+        }
+        pos = close + 1;
+    }
+
+    return result;
+}
+
+QString PathTemplate::resolve(const QString &entryPath, const QVector<QVariant> &fieldValues) const
+{
+    if (segments.isEmpty()) {
+        return QString();
+    }
+
+    QFileInfo entryInfo(entryPath);
+    QString entryDir = entryInfo.absolutePath();
+
+    QString result;
+    result.reserve(entryDir.size() + text.size() + 32);
+    for (const Segment &segment : segments) {
+        switch (segment.type) {
+        case Literal:
+            result += segment.text;
+            break;
+        case GroupName:
+            result += QStringView(entryDir).mid(entryDir.lastIndexOf('/') + 1);
+            break;
+        case EpisodeName:
+            result += entryInfo.baseName();
+            break;
+        case Field:
+            if (segment.field < fieldValues.size() && !fieldValues.at(segment.field).isNull()) {
+                result += fieldValues.at(segment.field).toString();
+            } else {
+                result += segment.text;
+            }
+            break;
+        }
+    }
+
+    // 相对路径接在entry文件所在目录之后
+    if (!QDir::isAbsolutePath(result)) {
+        result.prepend(entryDir + "/");
+    }
+    return result;
+}
+
+CompiledPattern CompiledPattern::compile(const QVariantMap &pattern)
+{
+    CompiledPattern compiled;
+    compiled.name = pattern.value("name").toString();
+
+    QVariantMap search = pattern.value("search").toMap();
+    compiled.hasGroup = search.value("has_group").toInt() == 1;
+    compiled.entryName = search.value("name").toString();
+    compiled.entryNameIsSuffix = compiled.entryName.startsWith('.');
+
+    QVariantMap parse = pattern.value("parse").toMap();
+    for (auto it = parse.begin(); it != parse.end(); ++it) {
+        JsonFieldPath path = JsonFieldPath::parse(it.value().toString());
+        if (!path.isEmpty()) {
+            compiled.parseFields.append({it.key(), path, VideoMetadata::fieldFromName(it.key())});
+        }
+    }
+
+    compiled.idPath = JsonFieldPath::parse(parse.value("sid").toString());
+    if (compiled.idPath.isEmpty()) {
+        compiled.idPath = JsonFieldPath::parse(parse.value("aid").toString());
+    }
+
+    // parse字段在前，模板引用的字段依次追加在后
+    for (const Field &field : compiled.parseFields) {
+        compiled.entryFields.append(field.path);
+    }
+
+    QVariantMap tree = search.value("tree").toMap();
+    compiled.videoTemplate = PathTemplate::parse(templateValue(tree, "v"), compiled.entryFields);
+    compiled.audioTemplate = PathTemplate::parse(templateValue(tree, "a"), compiled.entryFields);
+    compiled.danmakuTemplate = PathTemplate::parse(templateValue(tree, "d"), compiled.entryFields);
+    compiled.entryTemplate = PathTemplate::parse(templateValue(tree, "e"), compiled.entryFields);
+    compiled.coverTemplate = PathTemplate::parse(templateValue(tree, "c"), compiled.entryFields);
+
+    compiled.entryExtractor = JsonFieldExtractor(compiled.entryFields);
+    compiled.idExtractor = JsonFieldExtractor(QVector<JsonFieldPath>{compiled.idPath});
+
+    return compiled;
+}
+
+QString CompiledPattern::entryFileName(const QString &dirName) const
+{
+    return entryNameIsSuffix ? dirName + entryName : entryName;
+}
@@ -0,0 +1,110 @@
+#ifndef COMPILEDPATTERN_H
+#define COMPILEDPATTERN_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QVariantMap>
+#include <QJsonObject>
+#include <QJsonValue>
+#include "JsonFieldExtractor.h"
+#include "VideoMetadata.h"
+
+/**
+ * @brief 预先切分的JSON字段路径
+ * 模式文件中用'-'连接多级键，如 page_data-cid
+ */
+struct JsonFieldPath
+{
+    QString text;           // 原始写法
+    QStringList keys;       // 各级键
+
+    static JsonFieldPath parse(const QString &text);
+
+    bool isEmpty() const { return keys.isEmpty(); }
+
+    // 逐级查找，路径中途不是对象时返回Undefined
+    QJsonValue lookup(const QJsonObject &root) const;
+};
+
+/**
+ * @brief 预先切分的路径模板
+ * 模板按%name%切成字面量和占位符两类片段，解析时只做一次拼接：
+ * - %group%  入口文件所在目录名
+ * - %episode% 入口文件名（不含扩展名）
+ * - 其他占位符绑定到入口JSON中的一个字段（'-'连接多级键），取值由调用方一并提取
+ * 字段缺失时原样保留占位符文本；结果为相对路径时接在入口文件所在目录之后
+ */
+struct PathTemplate
+{
+    enum SegmentType {
+        Literal,
+        GroupName,
+        EpisodeName,
+        Field
+    };
+
+    struct Segment {
+        SegmentType type;
+        QString text;       // 字面量内容，或占位符原文（字段缺失时使用）
+        int field;          // Field类型对应的取值下标
+    };
+
+    QString text;           // 统一分隔符后的模板原文
+    QVector<Segment> segments;
+
+    bool isEmpty() const { return text.isEmpty(); }
+
+    // 切分模板，引用的字段路径追加到fields末尾（已有相同路径时复用其下标）
+    static PathTemplate parse(const QString &text, QVector<JsonFieldPath> &fields);
+
+    // entryPath为入口文件路径，fieldValues为该入口各字段的值（可为空，此时字段占位符保持原样）
+    QString resolve(const QString &entryPath, const QVector<QVariant> &fieldValues) const;
+};
+
+/**
+ * @brief 编译后的模式
+ * 由PatternManager在加载.pat文件时生成一次，扫描时只读使用，
+ * 不再逐目录查询和复制嵌套的QVariantMap
+ *
+ * - 路径模板已去掉null、统一为本平台的分隔符，并切分为PathTemplate
+ * - parse节的字段路径已切分，值为null的字段不保留
+ * - 入口字段 = parse字段 + 模板占位符引用的字段，由同一个提取器一次取出，
+ *   元数据和路径解析共用，入口文件只读一遍
+ */
+struct CompiledPattern
+{
+    struct Field {
+        QString name;           // 元数据字段名，如 cid
+        JsonFieldPath path;
+        VideoMetadata::Field slot;
+    };
+
+    QString name;
+    bool hasGroup = false;
+
+    // 入口文件名；以'.'开头时表示"所在目录名+后缀"（如WIN10客户端的 <目录名>.dvi）
+    QString entryName;
+    bool entryNameIsSuffix = false;
+
+    // 路径模板，未配置时为空
+    PathTemplate videoTemplate;
+    PathTemplate audioTemplate;
+    PathTemplate danmakuTemplate;
+    PathTemplate entryTemplate;
+    PathTemplate coverTemplate;
+
+    QVector<Field> parseFields;
+    QVector<JsonFieldPath> entryFields;     // 前parseFields.size()个与parseFields一一对应，其后为模板字段
+    JsonFieldPath idPath;       // 判断入口文件是否有效的字段：sid，未配置时用aid
+
+    JsonFieldExtractor entryExtractor;      // 按entryFields取值
+    JsonFieldExtractor idExtractor;         // 只取idPath
+
+    static CompiledPattern compile(const QVariantMap &pattern);
+
+    // dirName目录下的入口文件名
+    QString entryFileName(const QString &dirName) const;
+};
+
+#endif // COMPILEDPATTERN_H
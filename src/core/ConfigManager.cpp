@@ -2,13 +2,23 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QStandardPaths>
-#include <QApplication>
+#include <QCoreApplication>
+#include <QSaveFile>
 #include <QDebug>
 #include <cmath>
 
 ConfigManager::ConfigManager(QObject *parent)
     : QObject(parent)
+    , m_statsTimer(new QTimer(this))
+    , m_pendingVideoNum(0)
+    , m_pendingGroupNum(0)
+    , m_pendingTimeMs(0)
+    , m_statsFlushScheduled(false)
 {
+    m_statsTimer->setSingleShot(true);
+    m_statsTimer->setInterval(10000);
+    connect(m_statsTimer, &QTimer::timeout, this, &ConfigManager::flushStats);
+
     // 初始化默认路径
     initializeDefaultPaths();
 
@@ -21,6 +31,7 @@ ConfigManager::ConfigManager(QObject *parent)
 
 ConfigManager::~ConfigManager()
 {
+    flushStats();
 }
 
 void ConfigManager::initializeDefaultPaths()
@@ -68,6 +79,8 @@ bool ConfigManager::loadConfig()
 
 bool ConfigManager::saveConfig()
 {
+    // 顺带写入尚未落盘的统计，避免下次刷新时再写一遍
+    foldPendingStats();
     return saveConfigFile();
 }
 
@@ -188,7 +201,8 @@ bool ConfigManager::loadConfigFile()
 
 bool ConfigManager::saveConfigFile()
 {
-    QFile file(m_configFilePath);
+    // 写入临时文件后改名替换，中途失败或崩溃不会留下半截配置
+    QSaveFile file(m_configFilePath);
     if (!file.open(QIODevice::WriteOnly)) {
         qWarning() << "Failed to save config file:" << m_configFilePath;
         return false;
@@ -271,7 +285,10 @@ bool ConfigManager::saveConfigFile()
     }
     file.write("\n");
 
-    file.close();
+    if (!file.commit()) {
+        qWarning() << "Failed to save config file:" << m_configFilePath << file.errorString();
+        return false;
+    }
     return true;
 }
 
@@ -329,13 +346,13 @@ void ConfigManager::setPatternFilePath(const QString &path) { m_customPath["patt
 int ConfigManager::userRank() const { return m_record.value("userrank", 1).toInt(); }
 void ConfigManager::setUserRank(int rank) { m_record["userrank"] = rank; emit configChanged(); }
 
-int ConfigManager::totalVideoNum() const { return m_record.value("totalvideonum", 0).toInt(); }
+int ConfigManager::totalVideoNum() const { return m_record.value("totalvideonum", 0).toInt() + m_pendingVideoNum.load(); }
 void ConfigManager::setTotalVideoNum(int num) { m_record["totalvideonum"] = num; emit configChanged(); }
 
-int ConfigManager::totalGroupNum() const { return m_record.value("totalgroupnum", 0).toInt(); }
+int ConfigManager::totalGroupNum() const { return m_record.value("totalgroupnum", 0).toInt() + m_pendingGroupNum.load(); }
 void ConfigManager::setTotalGroupNum(int num) { m_record["totalgroupnum"] = num; emit configChanged(); }
 
-double ConfigManager::totalUsingTime() const { return m_record.value("totalusingtime", 0.0).toDouble(); }
+double ConfigManager::totalUsingTime() const { return m_record.value("totalusingtime", 0.0).toDouble() + m_pendingTimeMs.load() / 60000.0; }
 void ConfigManager::setTotalUsingTime(double time) { m_record["totalusingtime"] = time; emit configChanged(); }
 
 // 路径相关方法
@@ -348,23 +365,60 @@ QString ConfigManager::defaultFfprobePath() const { return m_ffprobePath; }
 // 用户统计和等级计算
 void ConfigManager::updateUserStats(int addedVideoNum, int addedGroupNum, double addedTimeMinutes)
 {
-    // 更新统计值
-    int newVideoNum = totalVideoNum() + addedVideoNum;
-    int newGroupNum = totalGroupNum() + addedGroupNum;
-    double newTotalTime = totalUsingTime() + addedTimeMinutes;
+    // 只累加内存计数，写盘交给flushStats()
+    m_pendingVideoNum.fetch_add(addedVideoNum);
+    m_pendingGroupNum.fetch_add(addedGroupNum);
+    m_pendingTimeMs.fetch_add(qRound64(addedTimeMinutes * 60000.0));
 
-    setTotalVideoNum(newVideoNum);
-    setTotalGroupNum(newGroupNum);
-    setTotalUsingTime(newTotalTime);
+    scheduleStatsFlush();
+}
 
-    // 重新计算等级
-    int newRank = calculateUserRank();
-    setUserRank(newRank);
+void ConfigManager::flushStats()
+{
+    // 先清标志，刷新期间的新增量会重新排期
+    m_statsFlushScheduled.store(false);
+    m_statsTimer->stop();
+
+    if (m_pendingVideoNum.load() == 0 && m_pendingGroupNum.load() == 0
+        && m_pendingTimeMs.load() == 0) {
+        return;
+    }
 
-    // 自动保存配置
     saveConfig();
 }
 
+bool ConfigManager::foldPendingStats()
+{
+    int videoNum = m_pendingVideoNum.exchange(0);
+    int groupNum = m_pendingGroupNum.exchange(0);
+    qint64 timeMs = m_pendingTimeMs.exchange(0);
+    if (videoNum == 0 && groupNum == 0 && timeMs == 0) {
+        return false;
+    }
+
+    // 直接改m_record，不逐项发configChanged（界面收到后会再次整体保存）
+    m_record["totalvideonum"] = m_record.value("totalvideonum", 0).toInt() + videoNum;
+    m_record["totalgroupnum"] = m_record.value("totalgroupnum", 0).toInt() + groupNum;
+    m_record["totalusingtime"] = m_record.value("totalusingtime", 0.0).toDouble() + timeMs / 60000.0;
+    m_record["userrank"] = calculateUserRank();
+    return true;
+}
+
+void ConfigManager::scheduleStatsFlush()
+{
+    // 只在一批更新的第一次启动定时器，之后的更新不重新计时：这是定期写盘而不是防抖
+    if (m_statsFlushScheduled.exchange(true)) {
+        return;
+    }
+
+    // 定时器只能在所属线程启动，其他线程调用时投递过去
+    QMetaObject::invokeMethod(this, [this]() {
+        if (m_statsFlushScheduled.load()) {
+            m_statsTimer->start();
+        }
+    }, Qt::AutoConnection);
+}
+
 int ConfigManager::calculateUserRank() const
 {
     int totalVideos = totalVideoNum();
@@ -9,6 +9,8 @@
 #include <QString>
 #include <QFile>
 #include <QTextStream>
+#include <QTimer>
+#include <atomic>
 
 /**
  * @brief 配置管理器类
@@ -19,6 +21,10 @@
  * - config.ini (GB18030编码)
  * - 支持自定义路径配置
  * - 用户记录和统计信息
+ *
+ * 合并统计先用原子计数累加在内存中，一批更新中的第一次更新10秒后（期间的更新一并写入）
+ * 或调用flushStats()时才合并进record section并整体写盘；持续合并时也至少每10秒落盘一次，
+ * 不会因为一直有新的更新而拖到最后。配置文件通过临时文件+改名原子替换
  */
 class ConfigManager : public QObject
 {
@@ -80,7 +86,9 @@ public:
     void setTotalUsingTime(double time);
 
     // 用户统计和等级计算
+    // updateUserStats只累加内存计数，可在任意线程调用；统计值的读取须在所属线程
     void updateUserStats(int addedVideoNum = 1, int addedGroupNum = 0, double addedTimeMinutes = 0);
+    void flushStats();                          // 立即写入未落盘的统计
     int calculateUserRank() const;
     QString getRankDescription(int rank) const;
     QString getRankTitle(int rank) const;
@@ -100,6 +108,8 @@ private:
     void ensureConfigDirectory();
     bool loadConfigFile();
     bool saveConfigFile();
+    bool foldPendingStats();
+    void scheduleStatsFlush();
 
     // 配置文件路径
     QString m_configFilePath;
@@ -112,6 +122,13 @@ private:
     QMap<QString, QVariant> m_config;
     QMap<QString, QVariant> m_customPath;
     QMap<QString, QVariant> m_record;
+
+    // 尚未并入m_record的统计增量
+    QTimer *m_statsTimer;
+    std::atomic<int> m_pendingVideoNum;
+    std::atomic<int> m_pendingGroupNum;
+    std::atomic<qint64> m_pendingTimeMs;
+    std::atomic<bool> m_statsFlushScheduled;
 };
 
 #endif // CONFIGMANAGER_H
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "CoverCache.h"
+#include "CoverDownloader.h"
+#include "Utils.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QEventLoop>
+#include <QMutexLocker>
+
+CoverCache::CoverCache(QObject *parent)
+    : QObject(parent)
+    , m_requestCount(0)
+{
+}
+
+CoverCache::~CoverCache()
+{
+}
+
+void CoverCache::setCacheDir(const QString &dir)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cacheDir = dir;
+}
+
+QString CoverCache::cacheDir() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cacheDir;
+}
+
+bool CoverCache::fetch(const QString &coverUrl, const QString &targetPath, QString &error)
+{
+    if (coverUrl.isEmpty()) {
+        error = "封面URL为空";
+        return false;
+    }
+
+    QString cachedPath;
+    bool isOwner = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.find(coverUrl);
+        if (it == m_entries.end()) {
+            // 第一个请求者负责下载
+            Entry entry;
+            entry.state = Fetching;
+            entry.cachedPath = QDir(m_cacheDir).filePath(Utils::calculateHash(coverUrl) + ".jpg");
+            m_entries.insert(coverUrl, entry);
+            m_requestCount++;
+            cachedPath = entry.cachedPath;
+            isOwner = true;
+        } else if (it->state == Fetching) {
+            // 下载进行中，登记后由下载者分发
+            it->waitingTargets.append(targetPath);
+            return true;
+        } else if (it->state == Failed) {
+            error = it->error;
+            return false;
+        } else {
+            cachedPath = it->cachedPath;
+        }
+    }
+
+    if (!isOwner) {
+        if (!Utils::linkOrCopyFile(cachedPath, targetPath)) {
+            error = QString("无法写入封面: %1").arg(targetPath);
+            return false;
+        }
+        return true;
+    }
+
+    QString downloadError;
+    bool success = download(coverUrl, cachedPath, downloadError);
+
+    QStringList targets;
+    {
+        QMutexLocker locker(&m_mutex);
+        Entry &entry = m_entries[coverUrl];
+        entry.state = success ? Ready : Failed;
+        entry.error = downloadError;
+        targets = entry.waitingTargets;
+        entry.waitingTargets.clear();
+    }
+
+    if (!success) {
+        error = downloadError;
+        if (!targets.isEmpty()) {
+            error += QString("（另有 %1 个分集使用同一封面）").arg(targets.size());
+        }
+        return false;
+    }
+
+    // 分发给自己和下载期间登记的所有目标
+    targets.prepend(targetPath);
+    int failed = 0;
+    for (const QString &target : targets) {
+        if (!Utils::linkOrCopyFile(cachedPath, target)) {
+            failed++;
+        }
+    }
+
+    if (failed > 0) {
+        error = QString("%1 个封面无法写入").arg(failed);
+        return false;
+    }
+    return true;
+}
+
+void CoverCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_requestCount = 0;
+    if (!m_cacheDir.isEmpty()) {
+        QDir(m_cacheDir).removeRecursively();
+    }
+}
+
+int CoverCache::requestCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_requestCount;
+}
+
+bool CoverCache::download(const QString &coverUrl, const QString &savePath, QString &error)
+{
+    // 先写入.part文件，成功后再改名，避免残缺封面被分发
+    QString partPath = savePath + ".part";
+
+    // 下载器需要属于当前线程，并由局部事件循环驱动
+    CoverDownloader downloader;
+    QEventLoop loop;
+    bool success = false;
+    QString lastMessage;
+
+    connect(&downloader, &CoverDownloader::downloadLog, &loop,
+            [&lastMessage](const QString &message) {
+                lastMessage = message;
+            });
+    connect(&downloader, &CoverDownloader::downloadCompleted, &loop,
+            [&loop, &success](bool ok, const QString &filePath) {
+                Q_UNUSED(filePath);
+                success = ok;
+                loop.quit();
+            });
+
+    if (!downloader.downloadCover(coverUrl, partPath)) {
+        error = lastMessage;
+        return false;
+    }
+
+    loop.exec();
+
+    if (!success) {
+        QFile::remove(partPath);
+        error = lastMessage.isEmpty() ? QString("下载失败: %1").arg(coverUrl) : lastMessage;
+        return false;
+    }
+
+    QFile::remove(savePath);
+    if (!QFile::rename(partPath, savePath)) {
+        QFile::remove(partPath);
+        error = QString("无法保存封面: %1").arg(savePath);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef COVERCACHE_H
+#define COVERCACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMutex>
+
+/**
+ * @brief 封面下载缓存
+ * 一次合并中同一个cover_url只发起一次网络请求
+ *
+ * 第一个请求者负责下载到缓存目录，下载期间到达的同URL请求只登记目标路径后立即返回，
+ * 下载完成后由下载者统一分发；之后的请求直接从缓存硬链接（失败时复制）到目标
+ * 可在多个线程中同时调用
+ */
+class CoverCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CoverCache(QObject *parent = nullptr);
+    ~CoverCache();
+
+    // 缓存目录（放在输出目录下，便于硬链接）
+    void setCacheDir(const QString &dir);
+    QString cacheDir() const;
+
+    // 将封面写入targetPath，返回false时error为失败原因
+    bool fetch(const QString &coverUrl, const QString &targetPath, QString &error);
+
+    // 清空记录并删除缓存目录（已链接出去的封面不受影响）
+    void clear();
+
+    // 实际发起的网络请求数
+    int requestCount() const;
+
+private:
+    enum State { Fetching, Ready, Failed };
+
+    struct Entry {
+        State state;
+        QString cachedPath;
+        QString error;
+        QStringList waitingTargets;   // 下载期间登记的目标路径
+    };
+
+    bool download(const QString &coverUrl, const QString &savePath, QString &error);
+
+    mutable QMutex m_mutex;
+    QString m_cacheDir;
+    QHash<QString, Entry> m_entries;
+    int m_requestCount;
+};
+
+#endif // COVERCACHE_H
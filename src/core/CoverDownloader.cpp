@@ -1,6 +1,6 @@
 #include "CoverDownloader.h"
 #include <QDebug>
-#include <QApplication>
+#include <QCoreApplication>
 #include <QDataStream>
 #include <QFileInfo>
 
@@ -176,6 +176,8 @@ void CoverDownloader::onTimeout()
     emit downloadLog("下载超时");
 
     if (m_reply) {
+        // 先断开连接，避免abort()同步触发onReplyFinished
+        m_reply->disconnect(this);
         m_reply->abort();
         m_reply->deleteLater();
         m_reply = nullptr;
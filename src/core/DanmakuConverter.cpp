@@ -13,6 +13,7 @@
 #include <QDir>
 #include <QCoreApplication>
 #include <cmath>
+#include <algorithm>
 
 DanmakuConverter::DanmakuConverter(QObject *parent)
     : QObject(parent)
@@ -20,7 +21,7 @@ DanmakuConverter::DanmakuConverter(QObject *parent)
 }
 
 bool DanmakuConverter::convertToASS(const QString &inputXmlPath, const QString &outputAssPath,
-                                    const DanmakuConfig &config)
+                                    const DanmakuConfig &config, int *commentCount)
 {
     emit conversionLog("开始转换弹幕文件...");
 
@@ -61,6 +62,11 @@ bool DanmakuConverter::convertToASS(const QString &inputXmlPath, const QString &
 
     emit conversionLog(QString("成功解析 %1 条弹幕").arg(items.size()));
 
+    // 碰撞检测要求按时间顺序处理，同一时刻保持原顺序
+    std::stable_sort(items.begin(), items.end(), [](const DanmakuItem &a, const DanmakuItem &b) {
+        return a.time < b.time;
+    });
+
     // 过滤重复弹幕（如果启用）
     if (config.reduceComments) {
         filterDuplicates(items);
@@ -83,6 +89,10 @@ bool DanmakuConverter::convertToASS(const QString &inputXmlPath, const QString &
 
     outputFile.close();
 
+    if (commentCount) {
+        *commentCount = items.size();
+    }
+
     emit conversionLog(QString("转换完成：%1").arg(outputAssPath));
     return true;
 }
@@ -237,10 +247,54 @@ void DanmakuConverter::writeASSHeader(QTextStream &output, const DanmakuConfig &
 void DanmakuConverter::writeComments(const QList<DanmakuItem> &items, QTextStream &output,
                                      const DanmakuConfig &config, const QString &styleId)
 {
-    QList<QList<DanmakuItem>> rows(4); // 4个滚动轨道
+    emit conversionLog("开始处理弹幕...");
+
+    QList<int> placement = layoutComments(items, config);
+    emitComments(items, placement, output, config, styleId);
+}
+
+QList<int> DanmakuConverter::layoutComments(const QList<DanmakuItem> &items, const DanmakuConfig &config)
+{
+    // 4个轨道，每个轨道按像素行记录最近占用该行的弹幕，底部留白区域不放弹幕
     int bottomReserved = static_cast<int>(config.stageHeight * config.reverseBlank);
+    int rowCount = std::max(1, config.stageHeight - bottomReserved);
+    QList<QList<DanmakuItem>> rows(4, QList<DanmakuItem>(rowCount));
 
-    emit conversionLog("开始处理弹幕...");
+    QList<int> placement(items.size(), -1);
+
+    for (int i = 0; i < items.size(); ++i) {
+        const DanmakuItem &item = items[i];
+
+        // 定位弹幕不占用轨道
+        if (item.type == "bilipos") {
+            continue;
+        }
+
+        int lane = item.type.toInt();
+        if (lane < 0 || lane >= rows.size()) {
+            continue;
+        }
+
+        int row = findAvailableRow(items, item, rows, config);
+        if (row < 0) {
+            continue;
+        }
+        placement[i] = row;
+
+        // 标记占用行
+        int rowEnd = row + static_cast<int>(std::ceil(item.lineHeight));
+        for (int r = row; r < rowEnd && r < rows[lane].size(); ++r) {
+            rows[lane][r] = item;
+        }
+    }
+
+    return placement;
+}
+
+void DanmakuConverter::emitComments(const QList<DanmakuItem> &items, const QList<int> &placement,
+                                    QTextStream &output, const DanmakuConfig &config, const QString &styleId)
+{
+    int bottomReserved = static_cast<int>(config.stageHeight * config.reverseBlank);
 
     for (int i = 0; i < items.size(); ++i) {
         if (i % 100 == 0) {
@@ -252,7 +306,7 @@ void DanmakuConverter::writeComments(const QList<DanmakuItem> &items, QTextStrea
 
         // 滚动弹幕
         if (item.type != "bilipos") {
-            int row = findAvailableRow(items, item, rows, config);
+            int row = placement[i];
             if (row >= 0) {
                 // 检查轨道类型
                 bool isTop = (item.type.toInt() == 1 || item.type.toInt() == 2);
@@ -261,12 +315,6 @@ void DanmakuConverter::writeComments(const QList<DanmakuItem> &items, QTextStrea
                 } else if (!isTop) {
                     writeMovingComment(output, item, row, config, styleId);
                 }
-
-                // 标记占用行
-                int rowEnd = row + static_cast<int>(std::ceil(item.lineHeight));
-                for (int r = row; r < rowEnd && r < rows[item.type.toInt()].size(); ++r) {
-                    rows[item.type.toInt()][r] = item;
-                }
             }
         }
         // 定位弹幕
@@ -10,15 +10,15 @@
 class QXmlStreamReader;
 
 struct DanmakuItem {
-    double time;          // 时间（秒）
-    int position;         // 位置
-    int index;           // 索引
-    QString text;        // 弹幕文本
-    QString type;        // 类型：滚动(0,2,3,4)、定位(bilipos)
-    int color;           // 颜色
-    double fontSize;     // 字体大小
-    double lineHeight;   // 行高
-    double textLength;   // 文本长度
+    double time = 0;              // 时间（秒）
+    int position = 0;             // 位置
+    int index = 0;                // 索引
+    QString text;                 // 弹幕文本
+    QString type;                 // 类型：滚动(0,2,3,4)、定位(bilipos)
+    int color = 0xffffff;         // 颜色
+    double fontSize = 0;          // 字体大小
+    double lineHeight = 0;        // 行高
+    double textLength = 0;        // 文本长度
 };
 
 struct DanmakuConfig {
@@ -36,12 +36,17 @@ struct DanmakuConfig {
 class DanmakuConverter : public QObject
 {
     Q_OBJECT
+
+    // 性能测试需要分阶段调用解析、过滤、排版和输出
+    friend class DanmakuBench;
+
 public:
     explicit DanmakuConverter(QObject *parent = nullptr);
 
     // 核心转换方法
+    // commentCount非空时返回写入的弹幕条数
     bool convertToASS(const QString &inputXmlPath, const QString &outputAssPath,
-                     const DanmakuConfig &config);
+                     const DanmakuConfig &config, int *commentCount = nullptr);
 
     // 检测弹幕格式
     QString detectFormat(const QString &xmlPath);
@@ -62,6 +67,12 @@ private:
     void writeComments(const QList<DanmakuItem> &items, QTextStream &output,
                       const DanmakuConfig &config, const QString &styleId);
 
+    // 排版：为每条非定位弹幕分配起始行，-1为无处可放
+    QList<int> layoutComments(const QList<DanmakuItem> &items, const DanmakuConfig &config);
+    // 按排版结果输出Dialogue行
+    void emitComments(const QList<DanmakuItem> &items, const QList<int> &placement,
+                      QTextStream &output, const DanmakuConfig &config, const QString &styleId);
+
     // 滚动弹幕处理
     void writeMovingComment(QTextStream &output, const DanmakuItem &item,
                            int row, const DanmakuConfig &config, const QString &styleId);
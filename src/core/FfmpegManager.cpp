@@ -3,8 +3,10 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
-#include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QTextStream>
 #include <QDebug>
+#include <QtConcurrent>
 
 FfmpegManager::FfmpegManager(ConfigManager *configManager, QObject *parent)
     : QObject(parent)
@@ -12,12 +14,21 @@ FfmpegManager::FfmpegManager(ConfigManager *configManager, QObject *parent)
     , m_process(nullptr)
     , m_progressTimer(nullptr)
     , m_isMerging(false)
+    , m_progressDirty(false)
+    , m_stallTimeoutMs(60000)
+    , m_lastOutTimeUs(-1)
+    , m_lastTotalSize(-1)
+    , m_processGeneration(0)
 {
     initializePaths();
 }
 
 FfmpegManager::~FfmpegManager()
 {
+    // 后台探测还在使用媒体信息缓存
+    for (QFuture<double> &probe : m_durationProbes) {
+        probe.waitForFinished();
+    }
     if (m_process) {
         m_process->kill();
         m_process->deleteLater();
@@ -34,6 +45,7 @@ void FfmpegManager::initializePaths()
         m_ffmpegPath = m_configManager->defaultFfmpegPath();
         m_ffprobePath = m_configManager->defaultFfprobePath();
     }
+    m_mediaInfo.setFfprobePath(m_ffprobePath);
 }
 
 QString FfmpegManager::ffmpegPath() const
@@ -75,25 +87,187 @@ QString FfmpegManager::ffmpegVersion() const
     return QString();
 }
 
-bool FfmpegManager::executeFfmpeg(const QStringList &arguments, QString &output, QString &error)
+bool FfmpegManager::executeFfmpeg(const QStringList &arguments, QString &output, QString &error,
+                                  int timeoutMs)
+{
+    ExecOptions options;
+    options.timeoutMs = timeoutMs;
+    return executeFfmpeg(arguments, output, error, options);
+}
+
+bool FfmpegManager::executeFfmpeg(const QStringList &arguments, QString &output, QString &error,
+                                  const ExecOptions &options)
 {
     if (!isValidFfmpegPath()) {
         error = tr("FFmpeg路径无效: %1").arg(m_ffmpegPath);
         return false;
     }
 
+    // 需要进度或卡死检测时以 -progress pipe:1 运行，stdout为key=value进度块
+    bool progressMode = options.onProgress || options.stallTimeoutMs > 0;
+
     QProcess process;
-    process.start(m_ffmpegPath, arguments);
-    if (!process.waitForFinished(30000)) { // 30秒超时
+    process.start(m_ffmpegPath, progressMode ? FfmpegProgressParser::arguments() + arguments : arguments);
+    if (!process.waitForStarted(5000)) {
+        error = tr("无法启动FFmpeg进程");
+        return false;
+    }
+
+    FfmpegProgressParser parser;
+    parser.reset(options.durationSeconds);
+    qint64 lastOutTimeUs = -1;
+    qint64 lastTotalSize = -1;
+
+    QElapsedTimer elapsed;
+    QElapsedTimer sinceProgress;
+    elapsed.start();
+    sinceProgress.start();
+
+    char buffer[4096];
+    auto drain = [&]() {
+        if (!progressMode) {
+            return;
+        }
+        qint64 size;
+        while ((size = process.read(buffer, sizeof(buffer))) > 0) {
+            if (!parser.feed(buffer, size)) {
+                continue;
+            }
+            // 输出时间或已写字节数有变化才算有进度（纯复制音频时out_time可能不变）
+            const FfmpegProgress &progress = parser.progress();
+            if (progress.outTimeUs != lastOutTimeUs || progress.totalSize != lastTotalSize) {
+                lastOutTimeUs = progress.outTimeUs;
+                lastTotalSize = progress.totalSize;
+                sinceProgress.restart();
+            }
+            if (options.onProgress) {
+                options.onProgress(progress);
+            }
+        }
+    };
+
+    auto abort = [&process, &error](const QString &reason) {
         process.kill();
-        error = tr("FFmpeg执行超时");
+        process.waitForFinished(3000);
+        error = reason;
         return false;
+    };
+
+    while (!process.waitForFinished(100)) {
+        if (process.state() == QProcess::NotRunning) {
+            break;
+        }
+        drain();
+
+        if (options.cancelRequested && options.cancelRequested()) {
+            return abort(tr("已取消"));
+        }
+        if (options.timeoutMs >= 0 && elapsed.elapsed() > options.timeoutMs) {
+            return abort(tr("FFmpeg执行超时"));
+        }
+        // 只要进度在推进就不限总时长，长片转码也能完成
+        if (options.stallTimeoutMs > 0 && sinceProgress.elapsed() > options.stallTimeoutMs) {
+            return abort(tr("FFmpeg已 %1 秒没有进度，判定为卡死").arg(options.stallTimeoutMs / 1000));
+        }
     }
+    drain();
 
-    output = QString::fromUtf8(process.readAllStandardOutput());
+    output = progressMode ? QString() : QString::fromUtf8(process.readAllStandardOutput());
     error = QString::fromUtf8(process.readAllStandardError());
 
-    return process.exitCode() == 0;
+    return process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0;
+}
+
+double FfmpegManager::mediaDuration(const QString &filePath)
+{
+    return m_mediaInfo.info(filePath).duration;
+}
+
+MediaInfoCache *FfmpegManager::mediaInfo()
+{
+    return &m_mediaInfo;
+}
+
+void FfmpegManager::setStallTimeout(int msecs)
+{
+    m_stallTimeoutMs = qMax(0, msecs);
+}
+
+double FfmpegManager::inputsDuration(const QStringList &inputs, bool concatenated, bool cachedOnly, bool *complete)
+{
+    double total = 0.0;
+    bool known = true;
+    for (const QString &input : inputs) {
+        MediaInfo info = cachedOnly ? m_mediaInfo.cachedInfo(input) : m_mediaInfo.info(input);
+        if (!info.probed) {
+            known = false;
+        }
+        total = concatenated ? total + info.duration : qMax(total, info.duration);
+    }
+    if (complete) {
+        *complete = known;
+    }
+    return total;
+}
+
+bool FfmpegManager::startProcess(const QStringList &arguments, const QStringList &inputs, bool concatenated)
+{
+    if (m_isMerging) {
+        emit ffmpegError(tr("已有FFmpeg任务在运行"));
+        return false;
+    }
+
+    // 创建进程
+    if (!m_process) {
+        m_process = new QProcess(this);
+        connect(m_process, &QProcess::readyReadStandardOutput, this, &FfmpegManager::onProcessReadyRead);
+        connect(m_process, &QProcess::readyReadStandardError, this, &FfmpegManager::onProcessReadyRead);
+        connect(m_process, &QProcess::finished, this, &FfmpegManager::onProcessFinished);
+    }
+
+    // 创建进度定时器
+    if (!m_progressTimer) {
+        m_progressTimer = new QTimer(this);
+        connect(m_progressTimer, &QTimer::timeout, this, &FfmpegManager::onProgressTimerTimeout);
+    }
+
+    bool durationKnown = false;
+    double durationSeconds = inputsDuration(inputs, concatenated, true, &durationKnown);
+
+    m_currentOutput.clear();
+    m_currentError.clear();
+    m_progressParser.reset(durationSeconds);
+    m_progressDirty = false;
+    m_lastOutTimeUs = -1;
+    m_lastTotalSize = -1;
+    m_sinceProgress.start();
+    m_isMerging = true;
+
+    // 启动FFmpeg进程
+    m_process->start(m_ffmpegPath, FfmpegProgressParser::arguments() + arguments);
+    if (!m_process->waitForStarted(5000)) {
+        emit ffmpegError(tr("无法启动FFmpeg进程"));
+        m_isMerging = false;
+        return false;
+    }
+
+    // 启动进度定时器（每100ms更新一次）
+    m_progressTimer->start(100);
+
+    quint64 generation = ++m_processGeneration;
+    if (!durationKnown) {
+        m_durationProbes.removeIf([](const QFuture<double> &probe) { return probe.isFinished(); });
+        QFuture<double> probe = QtConcurrent::run([this, inputs, concatenated]() {
+            return inputsDuration(inputs, concatenated, false);
+        });
+        probe.then(this, [this, generation](double duration) {
+            if (generation == m_processGeneration && m_isMerging) {
+                m_progressParser.setDuration(duration);
+            }
+        });
+        m_durationProbes.append(probe);
+    }
+    return true;
 }
 
 bool FfmpegManager::mergeVideoAudio(const QString &videoPath, const QString &audioPath,
@@ -131,36 +305,11 @@ bool FfmpegManager::mergeVideoAudio(const QString &videoPath, const QString &aud
     arguments << "-y"; // 覆盖输出文件
     arguments << outputPath;
 
-    // 创建进程
-    if (!m_process) {
-        m_process = new QProcess(this);
-        connect(m_process, &QProcess::readyReadStandardOutput, this, &FfmpegManager::onProcessReadyRead);
-        connect(m_process, &QProcess::readyReadStandardError, this, &FfmpegManager::onProcessReadyRead);
-        connect(m_process, &QProcess::finished, this, &FfmpegManager::onProcessFinished);
-    }
-
-    // 创建进度定时器
-    if (!m_progressTimer) {
-        m_progressTimer = new QTimer(this);
-        connect(m_progressTimer, &QTimer::timeout, this, &FfmpegManager::onProgressTimerTimeout);
-    }
-
-    m_currentOutput.clear();
-    m_currentError.clear();
-    m_isMerging = true;
     progress = 0.0;
-
-    // 启动FFmpeg进程
-    m_process->start(m_ffmpegPath, arguments);
-    if (!m_process->waitForStarted(5000)) {
-        emit ffmpegError(tr("无法启动FFmpeg进程"));
-        m_isMerging = false;
+    if (!startProcess(arguments, QStringList() << videoPath << audioPath)) {
         return false;
     }
 
-    // 启动进度定时器（每100ms更新一次）
-    m_progressTimer->start(100);
-
     emit ffmpegOutput(tr("开始合并: %1 + %2 -> %3").arg(videoPath, audioPath, outputPath));
     return true;
 }
@@ -169,33 +318,31 @@ void FfmpegManager::onProcessReadyRead()
 {
     if (!m_process) return;
 
+    // stdout只有-progress进度块，解析后由定时器节流发出
     QByteArray output = m_process->readAllStandardOutput();
-    QByteArray error = m_process->readAllStandardError();
+    if (!output.isEmpty() && m_progressParser.feed(output.constData(), output.size())) {
+        m_progressDirty = true;
+    }
 
-    QString outputStr = QString::fromUtf8(output);
+    QByteArray error = m_process->readAllStandardError();
     QString errorStr = QString::fromUtf8(error);
-
-    if (!outputStr.isEmpty()) {
-        m_currentOutput += outputStr;
-        emit ffmpegOutput(outputStr);
-    }
     if (!errorStr.isEmpty()) {
         m_currentError += errorStr;
         emit ffmpegError(errorStr);
-
-        // 解析进度信息
-        parseFfmpegOutput(errorStr);
     }
 }
 
 void FfmpegManager::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
-    Q_UNUSED(exitStatus);
-
     m_progressTimer->stop();
     m_isMerging = false;
 
-    if (exitCode == 0) {
+    // 发出最后一次进度
+    onProcessReadyRead();
+    emitProgress();
+
+    // 被终止的进程退出码不可靠，需同时检查退出状态
+    if (exitStatus == QProcess::NormalExit && exitCode == 0) {
         emit ffmpegOutput(tr("合并完成"));
         emit ffmpegFinished(true);
     } else {
@@ -212,51 +359,32 @@ void FfmpegManager::onProgressTimerTimeout()
 {
     if (!m_isMerging) return;
 
-    // 这里可以发送进度更新信号
-    // 实际进度计算在parseFfmpegOutput中处理
-    // emit progressUpdated(currentProgress);
-}
-
-void FfmpegManager::parseFfmpegOutput(const QString &output)
-{
-    // FFmpeg进度输出示例: "time=00:00:15.32 bitrate=1234.5kbits/s speed=1.23x"
-    QRegularExpression timeRegex("time=(\\d+):(\\d+):(\\d+)\\.(\\d+)");
-    QRegularExpression durationRegex("Duration: (\\d+):(\\d+):(\\d+)\\.(\\d+)");
-
-    // 查找总时长（通常在开始时输出）
-    static double totalDuration = 0.0;
-    if (totalDuration == 0.0) {
-        QRegularExpressionMatch durationMatch = durationRegex.match(output);
-        if (durationMatch.hasMatch()) {
-            int hours = durationMatch.captured(1).toInt();
-            int minutes = durationMatch.captured(2).toInt();
-            int seconds = durationMatch.captured(3).toInt();
-            int milliseconds = durationMatch.captured(4).left(2).toInt();
-            totalDuration = hours * 3600 + minutes * 60 + seconds + milliseconds * 0.01;
-        }
+    // 卡死检测：进度停滞过久时终止，由onProcessFinished报告失败
+    const FfmpegProgress &progress = m_progressParser.progress();
+    if (progress.outTimeUs != m_lastOutTimeUs || progress.totalSize != m_lastTotalSize) {
+        m_lastOutTimeUs = progress.outTimeUs;
+        m_lastTotalSize = progress.totalSize;
+        m_sinceProgress.restart();
+    } else if (m_stallTimeoutMs > 0 && m_sinceProgress.elapsed() > m_stallTimeoutMs) {
+        emit ffmpegError(tr("FFmpeg已 %1 秒没有进度，判定为卡死").arg(m_stallTimeoutMs / 1000));
+        m_process->kill();
+        return;
     }
 
-    // 查找当前时间
-    QRegularExpressionMatch timeMatch = timeRegex.match(output);
-    if (timeMatch.hasMatch() && totalDuration > 0) {
-        int hours = timeMatch.captured(1).toInt();
-        int minutes = timeMatch.captured(2).toInt();
-        int seconds = timeMatch.captured(3).toInt();
-        int milliseconds = timeMatch.captured(4).left(2).toInt();
-        double currentTime = hours * 3600 + minutes * 60 + seconds + milliseconds * 0.01;
-        double progress = (currentTime / totalDuration) * 100.0;
-        if (progress >= 0 && progress <= 100) {
-            emit progressUpdated(progress);
-        }
-    }
+    emitProgress();
 }
 
-double FfmpegManager::calculateProgressFromOutput(const QString &output)
+void FfmpegManager::emitProgress()
 {
-    // 这个方法可以用于更复杂的进度计算
-    // 目前在parseFfmpegOutput中直接处理
-    Q_UNUSED(output);
-    return 0.0;
+    if (!m_progressDirty) return;
+    m_progressDirty = false;
+
+    const FfmpegProgress &progress = m_progressParser.progress();
+    double percent = progress.percent();
+    if (percent >= 0) {
+        emit progressUpdated(percent);
+    }
+    emit progressDetail(progress.outTimeUs / 1e6, progress.speed, progress.bitrateKbps);
 }
 
 bool FfmpegManager::mergeAnyFormat(const QString &inputPath1, const QString &inputPath2,
@@ -310,23 +438,7 @@ bool FfmpegManager::mergeAnyFormat(const QString &inputPath1, const QString &inp
     args << "-y" << outputPath;
 
     // 执行合并
-    m_isMerging = true;
-    m_progressTimer->start(100);
-
-    m_process = new QProcess(this);
-    connect(m_process, &QProcess::readyRead, this, &FfmpegManager::onProcessReadyRead);
-    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &FfmpegManager::onProcessFinished);
-
-    m_process->start(m_ffmpegPath, args);
-
-    if (!m_process->waitForStarted(3000)) {
-        emit ffmpegError("启动FFmpeg失败");
-        m_isMerging = false;
-        return false;
-    }
-
-    return true;
+    return startProcess(args, QStringList() << videoPath << audioPath);
 }
 
 bool FfmpegManager::mergeBLVFiles(const QStringList &blvFiles, const QString &outputPath, double &progress)
@@ -362,31 +474,15 @@ bool FfmpegManager::mergeBLVFiles(const QStringList &blvFiles, const QString &ou
     }
     concatFile.close();
 
-    // 执行concat合并
+    // 执行concat合并，总时长为各分段之和
     QStringList args;
     args << "-f" << "concat" << "-safe" << "0" << "-i" << concatFilePath
          << "-c" << "copy" << "-y" << outputPath;
 
-    m_isMerging = true;
-    m_progressTimer->start(100);
-
-    m_process = new QProcess(this);
-    connect(m_process, &QProcess::readyRead, this, &FfmpegManager::onProcessReadyRead);
-    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &FfmpegManager::onProcessFinished);
-
-    m_process->start(m_ffmpegPath, args);
-
-    bool started = m_process->waitForStarted(3000);
+    bool started = startProcess(args, blvFiles, true);
     concatFile.remove(); // 立即删除临时文件
 
-    if (!started) {
-        emit ffmpegError("启动FFmpeg失败");
-        m_isMerging = false;
-        return false;
-    }
-
-    return true;
+    return started;
 }
 
 bool FfmpegManager::mergeSingleBLV(const QString &blvPath, const QString &outputPath, double &progress)
@@ -398,27 +494,17 @@ bool FfmpegManager::mergeSingleBLV(const QString &blvPath, const QString &output
     QStringList args;
     args << "-i" << blvPath << "-c" << "copy" << "-y" << outputPath;
 
-    m_isMerging = true;
-    m_progressTimer->start(100);
-
-    m_process = new QProcess(this);
-    connect(m_process, &QProcess::readyRead, this, &FfmpegManager::onProcessReadyRead);
-    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &FfmpegManager::onProcessFinished);
-
-    m_process->start(m_ffmpegPath, args);
-
-    if (!m_process->waitForStarted(3000)) {
-        emit ffmpegError("启动FFmpeg失败");
-        m_isMerging = false;
-        return false;
-    }
-
-    return true;
+    return startProcess(args, QStringList() << blvPath);
 }
 
 FfmpegManager::MediaType FfmpegManager::detectMediaType(const QString &filePath)
 {
+    // 优先按实际包含的流判断，m4s等扩展名无法区分音视频；在界面线程调用，只用扫描时已缓存的结果
+    MediaInfo info = m_mediaInfo.cachedInfo(filePath);
+    if (info.valid) {
+        return info.videoStreams > 0 ? VideoType : AudioType;
+    }
+
     QFileInfo fileInfo(filePath);
     QString ext = fileInfo.suffix().toLower();
 
@@ -438,6 +524,12 @@ FfmpegManager::MediaType FfmpegManager::detectMediaType(const QString &filePath)
 
 QString FfmpegManager::getMediaFormat(const QString &filePath)
 {
+    // 返回实际编码名（视频文件取视频编码），无法探测时退回扩展名
+    MediaInfo info = m_mediaInfo.cachedInfo(filePath);
+    if (info.valid) {
+        return info.videoStreams > 0 ? info.videoCodec : info.audioCodec;
+    }
+
     QFileInfo fileInfo(filePath);
     return fileInfo.suffix().toLower();
 }
@@ -447,7 +539,9 @@ bool FfmpegManager::needsTranscoding(const QString &format1, const QString &form
     // 无损格式需要转码
     QStringList losslessFormats = {"flac", "ape", "wav", "pcm"};
 
-    return losslessFormats.contains(format1) || losslessFormats.contains(format2);
+    // 探测得到的PCM编码名带有采样格式后缀，如 pcm_s16le
+    return losslessFormats.contains(format1) || losslessFormats.contains(format2)
+           || format1.startsWith("pcm_") || format2.startsWith("pcm_");
 }
 
 QStringList FfmpegManager::findMatchingFiles(const QStringList &files, const QString &baseName)
@@ -4,8 +4,13 @@
 #include <QObject>
 #include <QProcess>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QMap>
 #include <QString>
+#include <QFuture>
+#include <functional>
+#include "FfmpegProgress.h"
+#include "MediaInfoCache.h"
 
 class ConfigManager;
 
@@ -28,8 +33,31 @@ public:
     bool isValidFfmpegPath() const;
     QString ffmpegVersion() const;
 
-    // FFmpeg执行
-    bool executeFfmpeg(const QStringList &arguments, QString &output, QString &error);
+    // 同步执行选项
+    // onProgress或stallTimeoutMs生效时以 -progress pipe:1 运行，此时output为空
+    struct ExecOptions {
+        int timeoutMs = -1;             // 总时长上限，-1为不限时
+        int stallTimeoutMs = 0;         // 进度停滞超过此时间视为卡死并终止，0为不检测
+        double durationSeconds = 0.0;   // 输入总时长，用于计算百分比，未知时为0
+        std::function<void(const FfmpegProgress &)> onProgress;  // 每个进度块在调用线程中回调一次
+        std::function<bool()> cancelRequested;                   // 返回true时终止FFmpeg（约每100ms检查一次）
+    };
+
+    // FFmpeg执行（同步，使用局部进程，可在多个线程中同时调用）
+    bool executeFfmpeg(const QStringList &arguments, QString &output, QString &error,
+                       int timeoutMs = -1);
+    bool executeFfmpeg(const QStringList &arguments, QString &output, QString &error,
+                       const ExecOptions &options);
+
+    // 媒体时长（秒），来自媒体信息缓存，无法探测时返回0；未缓存时会启动ffprobe，不要在界面线程调用
+    double mediaDuration(const QString &filePath);
+
+    // ffprobe媒体信息缓存，扫描和合并共用
+    MediaInfoCache *mediaInfo();
+
+    // 异步合并的卡死检测：进度停滞超过此时间后终止FFmpeg，0为不检测
+    void setStallTimeout(int msecs);
+
     bool mergeVideoAudio(const QString &videoPath, const QString &audioPath,
                         const QString &outputPath, double &progress);
 
@@ -45,6 +73,7 @@ signals:
     void ffmpegOutput(const QString &output);
     void ffmpegError(const QString &error);
     void progressUpdated(double progress);
+    void progressDetail(double outTimeSeconds, double speed, double bitrateKbps);
     void ffmpegFinished(bool success);
 
 private slots:
@@ -54,8 +83,12 @@ private slots:
 
 private:
     void initializePaths();
-    void parseFfmpegOutput(const QString &output);
-    double calculateProgressFromOutput(const QString &output);
+
+    // 异步启动FFmpeg（带进度输出），inputs的总时长用于计算百分比（concatenated为true时各输入依次拼接，否则取最长）
+    // 不在界面线程探测：时长未缓存时先按未知启动，后台探测完成后再补上
+    bool startProcess(const QStringList &arguments, const QStringList &inputs, bool concatenated = false);
+    double inputsDuration(const QStringList &inputs, bool concatenated, bool cachedOnly, bool *complete = nullptr);
+    void emitProgress();
 
     // 媒体格式检测
     enum MediaType { VideoType, AudioType, UnknownType };
@@ -75,6 +108,18 @@ private:
     QString m_currentOutput;
     QString m_currentError;
     bool m_isMerging;
+
+    // 异步合并的进度，由定时器节流后发出
+    FfmpegProgressParser m_progressParser;
+    bool m_progressDirty;
+    int m_stallTimeoutMs;
+    QElapsedTimer m_sinceProgress;
+    qint64 m_lastOutTimeUs;
+    qint64 m_lastTotalSize;
+    quint64 m_processGeneration;    // 每次启动加一，后台探测结果只用于发起它的那次合并
+    QList<QFuture<double>> m_durationProbes;     // 尚未结束的后台时长探测
+
+    MediaInfoCache m_mediaInfo;
 };
 
 #endif // FFMPEGMANAGER_H
\ No newline at end of file
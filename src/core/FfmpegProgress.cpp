@@ -0,0 +1,141 @@
+#include "FfmpegProgress.h"
+#include <QByteArrayView>
+#include <QStringList>
+#include <cstring>
+
+double FfmpegProgress::percent() const
+{
+    if (durationSeconds <= 0.0) {
+        return -1.0;
+    }
+    if (finished) {
+        return 100.0;
+    }
+    double value = outTimeUs / 1e6 / durationSeconds * 100.0;
+    return qBound(0.0, value, 100.0);
+}
+
+FfmpegProgressParser::FfmpegProgressParser()
+    : m_blockHasOutTimeUs(false)
+{
+    m_partial.reserve(128);
+}
+
+void FfmpegProgressParser::reset(double durationSeconds)
+{
+    m_partial.clear();
+    m_current = FfmpegProgress();
+    m_current.durationSeconds = durationSeconds;
+    m_last = m_current;
+    m_blockHasOutTimeUs = false;
+}
+
+void FfmpegProgressParser::setDuration(double durationSeconds)
+{
+    m_current.durationSeconds = durationSeconds;
+    m_last.durationSeconds = durationSeconds;
+}
+
+QStringList FfmpegProgressParser::arguments()
+{
+    // 进度以key=value写到stdout，关闭stderr上的统计行
+    return QStringList() << "-nostats" << "-progress" << "pipe:1";
+}
+
+bool FfmpegProgressParser::feed(const char *data, qsizetype size)
+{
+    bool updated = false;
+    const char *end = data + size;
+    const char *lineStart = data;
+
+    while (lineStart < end) {
+        const char *newline = static_cast<const char *>(std::memchr(lineStart, '\n', end - lineStart));
+        if (!newline) {
+            m_partial.append(lineStart, end - lineStart);
+            break;
+        }
+
+        if (m_partial.isEmpty()) {
+            updated = parseLine(lineStart, newline) || updated;
+        } else {
+            m_partial.append(lineStart, newline - lineStart);
+            updated = parseLine(m_partial.constData(), m_partial.constData() + m_partial.size()) || updated;
+            m_partial.clear();
+        }
+        lineStart = newline + 1;
+    }
+
+    return updated;
+}
+
+bool FfmpegProgressParser::parseLine(const char *begin, const char *end)
+{
+    // Windows下行尾为\r\n
+    if (end > begin && end[-1] == '\r') {
+        --end;
+    }
+
+    const char *equals = static_cast<const char *>(std::memchr(begin, '=', end - begin));
+    if (!equals) {
+        return false;
+    }
+
+    QByteArrayView key(begin, equals - begin);
+    const char *value = equals + 1;
+
+    if (key == "out_time_us") {
+        m_current.outTimeUs = parseInteger(value, end);
+        m_blockHasOutTimeUs = true;
+    } else if (key == "out_time_ms") {
+        // 旧版本FFmpeg只输出out_time_ms，单位实际也是微秒；m_current跨块保留，按本块是否有out_time_us判断
+        if (!m_blockHasOutTimeUs) {
+            m_current.outTimeUs = parseInteger(value, end);
+        }
+    } else if (key == "total_size") {
+        m_current.totalSize = parseInteger(value, end);
+    } else if (key == "frame") {
+        m_current.frame = parseInteger(value, end);
+    } else if (key == "speed") {
+        m_current.speed = parseDecimal(value, end);     // "1.23x"，N/A时为0
+    } else if (key == "bitrate") {
+        m_current.bitrateKbps = parseDecimal(value, end);   // "1234.5kbits/s"
+    } else if (key == "progress") {
+        m_current.finished = QByteArrayView(value, end - value) == "end";
+        m_last = m_current;
+        m_blockHasOutTimeUs = false;
+        return true;
+    }
+
+    return false;
+}
+
+qint64 FfmpegProgressParser::parseInteger(const char *begin, const char *end)
+{
+    // N/A或负数（开头阶段）按0处理
+    qint64 value = 0;
+    for (const char *p = begin; p < end && *p >= '0' && *p <= '9'; ++p) {
+        value = value * 10 + (*p - '0');
+    }
+    return value;
+}
+
+double FfmpegProgressParser::parseDecimal(const char *begin, const char *end)
+{
+    const char *p = begin;
+    while (p < end && *p == ' ') {
+        ++p;
+    }
+
+    double value = 0.0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        value = value * 10.0 + (*p - '0');
+    }
+    if (p < end && *p == '.') {
+        double scale = 0.1;
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+            value += (*p - '0') * scale;
+            scale *= 0.1;
+        }
+    }
+    return value;
+}
@@ -0,0 +1,61 @@
+#ifndef FFMPEGPROGRESS_H
+#define FFMPEGPROGRESS_H
+
+#include <QByteArray>
+#include <QStringList>
+#include <QtGlobal>
+
+/**
+ * @brief FFmpeg进度快照
+ * 对应 -progress 输出的一个块（以 progress=continue/end 结束）
+ */
+struct FfmpegProgress {
+    qint64 outTimeUs = 0;           // 已输出的媒体时长（微秒）
+    qint64 totalSize = 0;           // 已写出字节数
+    qint64 frame = 0;               // 已处理帧数（纯复制音频时为0）
+    double speed = 0.0;             // 处理速度倍率，未知时为0
+    double bitrateKbps = 0.0;       // 输出码率，未知时为0
+    double durationSeconds = 0.0;   // 输入总时长，未知时为0
+    bool finished = false;          // progress=end
+
+    // 百分比(0-100)，总时长未知时返回-1
+    double percent() const;
+};
+
+/**
+ * @brief FFmpeg -progress 输出解析器
+ * 按行解析 key=value，不使用正则，完整行直接在输入缓冲上解析，
+ * 只有跨读取边界的半行才会被复制
+ */
+class FfmpegProgressParser
+{
+public:
+    FfmpegProgressParser();
+
+    // 开始新任务前调用
+    void reset(double durationSeconds = 0.0);
+
+    // 任务进行中得知输入时长后补上
+    void setDuration(double durationSeconds);
+
+    // 输入一段stdout数据，有新的完整进度块时返回true
+    bool feed(const char *data, qsizetype size);
+
+    // 最近一个完整的进度块
+    const FfmpegProgress &progress() const { return m_last; }
+
+    // 需要添加到FFmpeg参数最前面的选项
+    static QStringList arguments();
+
+private:
+    bool parseLine(const char *begin, const char *end);
+    static qint64 parseInteger(const char *begin, const char *end);
+    static double parseDecimal(const char *begin, const char *end);
+
+    QByteArray m_partial;           // 未读完的半行
+    FfmpegProgress m_current;       // 正在累积的块
+    bool m_blockHasOutTimeUs;       // 当前块中出现过out_time_us
+    FfmpegProgress m_last;
+};
+
+#endif // FFMPEGPROGRESS_H
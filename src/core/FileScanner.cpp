@@ -1,19 +1,49 @@
 #include "FileScanner.h"
 #include "core/ConfigManager.h"
 #include "core/PatternManager.h"
+#include "core/TraceRecorder.h"
+#include "core/MediaInfoCache.h"
+#include "core/TolerantJsonReader.h"
 #include <QDir>
 #include <QFileInfo>
 #include <QFile>
+#include <QSaveFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QRegularExpression>
 #include <QDebug>
+#include <QtConcurrent>
+#include <climits>
+#include <utility>
+
+namespace {
+
+// 全部为数字时返回其值，否则返回-1（最多9位，不会溢出）
+int segmentNumber(QStringView digits)
+{
+    if (digits.isEmpty() || digits.size() > 9) {
+        return -1;
+    }
+    int number = 0;
+    for (QChar ch : digits) {
+        const char16_t code = ch.unicode();
+        if (code < u'0' || code > u'9') {
+            return -1;
+        }
+        number = number * 10 + (code - u'0');
+    }
+    return number;
+}
+
+} // namespace
 
 FileScanner::FileScanner(ConfigManager *configManager, PatternManager *patternManager, QObject *parent)
     : QObject(parent)
     , m_configManager(configManager)
     , m_patternManager(patternManager)
+    , m_trace(nullptr)
+    , m_mediaInfo(nullptr)
     , m_totalFiles(0)
     , m_totalGroups(0)
 {
@@ -25,21 +55,32 @@ FileScanner::~FileScanner()
 {
 }
 
+void FileScanner::setTraceRecorder(TraceRecorder *recorder)
+{
+    m_trace = recorder;
+}
+
+void FileScanner::setMediaInfoCache(MediaInfoCache *cache)
+{
+    m_mediaInfo = cache;
+}
+
 bool FileScanner::scan(const ScanConfig &config)
 {
     m_config = config;
     m_videoGroups.clear();
+    m_strings.clear();
     m_totalFiles = 0;
     m_totalGroups = 0;
 
     emit scanLog(tr("开始扫描目录: %1").arg(config.searchPath));
 
-    // 获取要使用的模式
-    QMap<QString, QVariantMap> patterns;
+    // 获取要使用的模式（加载时已编译）
+    QMap<QString, CompiledPattern> patterns;
     if (!config.patternName.isEmpty()) {
         // 使用指定模式
         if (m_patternManager->loadPatternByName(config.patternName)) {
-            patterns = m_patternManager->patterns();
+            patterns = m_patternManager->compiledPatterns();
         } else {
             emit scanError(tr("无法加载指定模式: %1").arg(config.patternName));
             return false;
@@ -50,17 +91,27 @@ bool FileScanner::scan(const ScanConfig &config)
             emit scanError(tr("无法加载任何模式文件"));
             return false;
         }
-        patterns = m_patternManager->patterns();
+        patterns = m_patternManager->compiledPatterns();
     }
 
     // 扫描目录
     bool success = false;
-    for (const auto &pattern : patterns) {
+    for (const CompiledPattern &pattern : patterns) {
+        TraceSpan span(m_trace, "scan.pattern", pattern.name);
         if (scanDirectory(config.searchPath, pattern)) {
             success = true;
         }
     }
 
+    // 驻留表只在扫描期间用于去重，字符串本身由扫描结果持有
+    m_strings.clear();
+
+    // 媒体文件在遍历结束后统一校验，ffprobe可以并行
+    if (success) {
+        validateMediaFiles();
+        success = !m_videoGroups.isEmpty();
+    }
+
     if (success) {
         emit scanLog(tr("扫描完成，找到 %1 组共 %2 个文件").arg(m_totalGroups).arg(m_totalFiles));
         emit scanCompleted(true);
@@ -72,11 +123,16 @@ bool FileScanner::scan(const ScanConfig &config)
     return success;
 }
 
-QList<FileScanner::VideoGroup> FileScanner::videoGroups() const
+const QList<FileScanner::VideoGroup> &FileScanner::videoGroups() const
 {
     return m_videoGroups;
 }
 
+QList<FileScanner::VideoGroup> FileScanner::takeVideoGroups()
+{
+    return std::exchange(m_videoGroups, QList<VideoGroup>());
+}
+
 int FileScanner::totalFiles() const
 {
     return m_totalFiles;
@@ -87,7 +143,7 @@ int FileScanner::totalGroups() const
     return m_totalGroups;
 }
 
-bool FileScanner::scanDirectory(const QString &path, const QVariantMap &pattern)
+bool FileScanner::scanDirectory(const QString &path, const CompiledPattern &pattern)
 {
     QDir dir(path);
     if (!dir.exists()) {
@@ -95,60 +151,57 @@ bool FileScanner::scanDirectory(const QString &path, const QVariantMap &pattern)
         return false;
     }
 
-    // 获取模式信息
-    QString patternName = pattern.value("name").toString();
-    QVariantMap searchSection = pattern.value("search").toMap();
-    bool hasGroup = searchSection.value("has_group").toInt() == 1;
-    QString entryName = searchSection.value("name").toString();
-    QVariantMap treeSection = searchSection.value("tree").toMap();
-
-    emit scanLog(tr("使用模式 %1 扫描目录: %2").arg(patternName).arg(path));
+    emit scanLog(tr("使用模式 %1 扫描目录: %2").arg(pattern.name).arg(path));
 
     // 获取目录中的所有条目
-    QFileInfoList entries = dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+    QFileInfoList entries;
+    {
+        TraceSpan span(m_trace, "scan.walk", path);
+        entries = dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+    }
 
     // 首先检查非分组模式（单个视频）
-    if (!hasGroup) {
+    if (!pattern.hasGroup) {
         for (const QFileInfo &entry : entries) {
-            if (entry.isFile() && entry.fileName() == entryName) {
+            if (entry.isFile() && entry.fileName() == pattern.entryName) {
                 if (isEntryFile(entry.absoluteFilePath(), pattern)) {
                     // 找到entry文件，创建视频文件组
                     VideoFile videoFile;
                     videoFile.entryPath = entry.absoluteFilePath();
 
+                    // 提取元数据，同时取出路径模板引用的字段
+                    QVector<QVariant> fieldValues;
+                    videoFile.metadata = extractMetadata(videoFile.entryPath, pattern, &fieldValues);
+
                     // 解析视频和音频路径
-                    QString videoTemplate = treeSection.value("v").toString();
-                    QString audioTemplate = treeSection.value("a").toString();
-                    videoFile.videoPath = resolvePathTemplate(videoTemplate, entry.absoluteFilePath(), pattern);
-                    videoFile.audioPath = resolvePathTemplate(audioTemplate, entry.absoluteFilePath(), pattern);
+                    videoFile.videoPath = pattern.videoTemplate.resolve(videoFile.entryPath, fieldValues);
+                    videoFile.audioPath = pattern.audioTemplate.resolve(videoFile.entryPath, fieldValues);
 
                     // 解析弹幕路径
-                    QString danmuTemplate = treeSection.value("d").toString();
-                    if (!danmuTemplate.isEmpty() && danmuTemplate != "null") {
-                        videoFile.danmuPath = resolvePathTemplate(danmuTemplate, entry.absoluteFilePath(), pattern);
+                    if (!pattern.danmakuTemplate.isEmpty()) {
+                        videoFile.danmuPath = pattern.danmakuTemplate.resolve(videoFile.entryPath, fieldValues);
                     }
 
-                    // 提取元数据
-                    videoFile.metadata = extractMetadata(entry.absoluteFilePath(), pattern.value("parse").toMap());
-
-                    // 验证媒体文件对是否有效
-                    if (!hasValidMediaPair(videoFile)) {
-                        emit scanLog(tr("跳过无效的媒体文件对: %1").arg(videoFile.entryPath));
+                    // PC客户端的BLV分段与entry在同一目录，直接使用已列出的条目
+                    QString blvError;
+                    if (!indexBLVSegments(videoFile, entries, &blvError)) {
+                        emit scanLog(tr("[WARNING] BLV分段不完整，跳过: %1 (%2)").arg(videoFile.entryPath, blvError));
                         continue;
                     }
 
                     // 创建视频组
                     VideoGroup group;
-                    group.patternName = patternName;
+                    group.patternName = pattern.name;
                     group.groupEntryPath = QString(); // 非分组模式没有组entry
-                    group.files.append(videoFile);
-                    group.groupMetadata = videoFile.metadata;
+                    group.title = videoFile.metadata.title;   // 与分集共用同一个字符串
+                    emit scanLog(tr("找到视频文件: %1").arg(videoFile.entryPath));
+                    group.files.append(std::move(videoFile));
 
-                    m_videoGroups.append(group);
+                    m_videoGroups.append(std::move(group));
                     m_totalFiles++;
                     m_totalGroups++;
 
-                    emit scanLog(tr("找到视频文件: %1").arg(videoFile.entryPath));
+                    // entry所在目录即一个分集，其子目录只存放媒体文件，无需继续深入
                     return true;
                 }
             }
@@ -156,15 +209,12 @@ bool FileScanner::scanDirectory(const QString &path, const QVariantMap &pattern)
     }
 
     // 检查分组模式
-    if (hasGroup) {
+    if (pattern.hasGroup) {
         // 查找组entry文件（通常在根目录）
         QString groupEntryPath;
+        const QString checkName = pattern.entryFileName(dir.dirName());
         for (const QFileInfo &entry : entries) {
             if (entry.isFile()) {
-                QString checkName = entryName;
-                if (checkName.startsWith('.')) {
-                    checkName = dir.dirName() + checkName;
-                }
                 if (entry.fileName() == checkName) {
                     if (isEntryFile(entry.absoluteFilePath(), pattern)) {
                         groupEntryPath = entry.absoluteFilePath();
@@ -177,70 +227,79 @@ bool FileScanner::scanDirectory(const QString &path, const QVariantMap &pattern)
         if (!groupEntryPath.isEmpty()) {
             // 找到组entry，现在扫描子目录
             VideoGroup group;
-            group.patternName = patternName;
+            group.patternName = pattern.name;
             group.groupEntryPath = groupEntryPath;
-            group.groupMetadata = extractMetadata(groupEntryPath, pattern.value("parse").toMap());
+            QVector<QVariant> groupValues;
+            group.title = extractMetadata(groupEntryPath, pattern, &groupValues).title;
 
             // 解析封面路径
-            QString coverTemplate = treeSection.value("c").toString();
-            if (!coverTemplate.isEmpty() && coverTemplate != "null") {
-                group.coverPath = resolvePathTemplate(coverTemplate, groupEntryPath, pattern);
+            if (!pattern.coverTemplate.isEmpty()) {
+                group.coverPath = pattern.coverTemplate.resolve(groupEntryPath, groupValues);
             }
 
             // 扫描子目录
             for (const QFileInfo &entry : entries) {
                 if (entry.isDir()) {
                     QString subDirPath = entry.absoluteFilePath();
-                    QString videoEntryTemplate = treeSection.value("e").toString();
-                    QString videoEntryPath = resolvePathTemplate(videoEntryTemplate, subDirPath, pattern);
+                    // 以子目录本身作为"entry"解析：%group%为当前目录名，%episode%为子目录名
+                    QString videoEntryPath = pattern.entryTemplate.resolve(subDirPath, QVector<QVariant>());
 
                     if (QFile::exists(videoEntryPath)) {
                         VideoFile videoFile;
                         videoFile.entryPath = videoEntryPath;
-                        videoFile.videoPath = subDirPath + "/" + treeSection.value("v").toString();
-                        videoFile.audioPath = subDirPath + "/" + treeSection.value("a").toString();
+                        videoFile.videoPath = subDirPath + "/" + pattern.videoTemplate.text;
+                        videoFile.audioPath = subDirPath + "/" + pattern.audioTemplate.text;
 
-                        QString danmuTemplate = treeSection.value("d").toString();
-                        if (!danmuTemplate.isEmpty() && danmuTemplate != "null") {
-                            videoFile.danmuPath = resolvePathTemplate(danmuTemplate, videoEntryPath, pattern);
-                        }
+                        QVector<QVariant> fieldValues;
+                        videoFile.metadata = extractMetadata(videoEntryPath, pattern, &fieldValues);
 
-                        videoFile.metadata = extractMetadata(videoEntryPath, pattern.value("parse").toMap());
+                        if (!pattern.danmakuTemplate.isEmpty()) {
+                            videoFile.danmuPath = pattern.danmakuTemplate.resolve(videoEntryPath, fieldValues);
+                        }
 
-                        // 验证媒体文件对是否有效
-                        if (hasValidMediaPair(videoFile)) {
-                            group.files.append(videoFile);
-                            m_totalFiles++;
-                        } else {
-                            emit scanLog(tr("跳过无效的媒体文件对: %1").arg(videoFile.entryPath));
+                        // 没有视频文件时才列出子目录查找BLV分段
+                        if (!QFileInfo::exists(videoFile.videoPath)) {
+                            QString blvError;
+                            if (!indexBLVSegments(videoFile, QDir(subDirPath).entryInfoList(QDir::Files), &blvError)) {
+                                emit scanLog(tr("[WARNING] BLV分段不完整，跳过: %1 (%2)").arg(videoFile.entryPath, blvError));
+                                continue;
+                            }
                         }
+
+                        // 媒体文件对是否有效在validateMediaFiles()中统一检查
+                        group.files.append(std::move(videoFile));
+                        m_totalFiles++;
                     }
                 }
             }
 
             if (!group.files.isEmpty()) {
-                m_videoGroups.append(group);
-                m_totalGroups++;
                 emit scanLog(tr("找到视频组: %1 (包含 %2 个文件)").arg(groupEntryPath).arg(group.files.size()));
+                m_videoGroups.append(std::move(group));
+                m_totalGroups++;
+                // 子目录都已作为分集处理
                 return true;
             }
         }
     }
 
-    // 递归扫描子目录
+    // 递归扫描子目录，收集全部视频而不是找到第一个就停止
+    bool found = false;
     for (const QFileInfo &entry : entries) {
         if (entry.isDir()) {
             if (scanDirectory(entry.absoluteFilePath(), pattern)) {
-                return true;
+                found = true;
             }
         }
     }
 
-    return false;
+    return found;
 }
 
-bool FileScanner::isEntryFile(const QString &filePath, const QVariantMap &pattern)
+bool FileScanner::isEntryFile(const QString &filePath, const CompiledPattern &pattern)
 {
+    TraceSpan span(m_trace, "scan.check_entry", filePath);
+
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
         return false;
@@ -249,111 +308,23 @@ bool FileScanner::isEntryFile(const QString &filePath, const QVariantMap &patter
     QByteArray data = file.readAll();
     file.close();
 
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
-        return false;
-    }
-
-    QJsonObject jsonObj = doc.object();
-    QVariantMap parseSection = pattern.value("parse").toMap();
-
-    // 检查必要的字段是否存在
-    QString key = parseSection.value("sid").toString();
-    if (key.isEmpty()) {
-        key = parseSection.value("aid").toString();
-    }
-
-    if (key.isEmpty()) {
+    // 检查必要的字段（sid，未配置时为aid）是否存在
+    if (pattern.idPath.isEmpty()) {
         return false;
     }
 
-    QVariant value = getValueFromJsonPath(jsonObj, key);
+    // 取到该字段即可判定，文件后面的内容不影响结果
+    QVector<QVariant> values;
+    pattern.idExtractor.extract(data, values);
+    const QVariant &value = values.first();
     return !value.isNull() && !value.toString().isEmpty();
 }
 
-QString FileScanner::resolvePathTemplate(const QString &templateStr, const QString &entryPath, const QVariantMap &pattern)
+VideoMetadata FileScanner::extractMetadata(const QString &entryPath, const CompiledPattern &pattern,
+                                           QVector<QVariant> *fieldValues)
 {
-    // pattern参数保留用于未来扩展，当前实现直接从entryPath读取JSON
-    Q_UNUSED(pattern);
-
-    if (templateStr.isEmpty() || templateStr == "null") {
-        return QString();
-    }
-
-    QString result = templateStr;
-
-    // 首先处理路径分隔符（在变量替换之前）
-    if (QDir::separator() == '/') {
-        result.replace('\\', '/');
-    } else {
-        result.replace('/', '\\');
-    }
-
-    // 获取entry文件的目录
-    QFileInfo entryInfo(entryPath);
-    QString entryDir = entryInfo.absolutePath();
-    QString entryBaseName = entryInfo.baseName();
-
-    // 处理%group%和%episode%变量
-    result.replace("%group%", entryDir.split('/').last());
-    result.replace("%episode%", entryBaseName);
-
-    // 处理其他JSON字段变量（包括嵌套字段）
-    QFile entryFile(entryPath);
-    if (entryFile.open(QIODevice::ReadOnly)) {
-        QByteArray jsonData = entryFile.readAll();
-        entryFile.close();
-
-        QJsonParseError parseError;
-        QJsonDocument doc = QJsonDocument::fromJson(jsonData, &parseError);
-        if (parseError.error == QJsonParseError::NoError && doc.isObject()) {
-            QJsonObject jsonObj = doc.object();
-
-            // 预先提取所有可能的变量值
-            QMap<QString, QString> variables;
-
-            // 处理根级别字段
-            for (auto it = jsonObj.begin(); it != jsonObj.end(); ++it) {
-                QString key = it.key();
-                QVariant value = it.value().toVariant();
-                if (value.isValid()) {
-                    variables["%" + key + "%"] = value.toString();
-                }
-            }
-
-            // 处理常见的嵌套字段（如page_data-cid）
-            for (auto it = jsonObj.begin(); it != jsonObj.end(); ++it) {
-                if (it.value().isObject()) {
-                    QJsonObject subObj = it.value().toObject();
-                    for (auto subIt = subObj.begin(); subIt != subObj.end(); ++subIt) {
-                        QString nestedKey = it.key() + "-" + subIt.key();
-                        QVariant value = subIt.value().toVariant();
-                        if (value.isValid()) {
-                            variables["%" + nestedKey + "%"] = value.toString();
-                        }
-                    }
-                }
-            }
-
-            // 执行变量替换
-            for (auto varIt = variables.begin(); varIt != variables.end(); ++varIt) {
-                result.replace(varIt.key(), varIt.value());
-            }
-        }
-    }
-
-    // 如果结果是相对路径，需要转换为绝对路径
-    if (!QDir::isAbsolutePath(result)) {
-        result = entryDir + "/" + result;
-    }
-
-    return result;
-}
-
-QVariantMap FileScanner::extractMetadata(const QString &entryPath, const QVariantMap &parseRules)
-{
-    QVariantMap metadata;
+    VideoMetadata metadata;
+    TraceSpan span(m_trace, "scan.parse_json", entryPath);
 
     QFile file(entryPath);
     if (!file.open(QIODevice::ReadOnly)) {
@@ -364,20 +335,41 @@ QVariantMap FileScanner::extractMetadata(const QString &entryPath, const QVarian
     QByteArray data = file.readAll();
     file.close();
 
-    // 尝试解析JSON
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+    // 只扫描一遍原始字节取出所需字段；取全之前遇到语法错误时才走下面的完整解析和修复
+    QVector<QVariant> values;
+    if (pattern.entryExtractor.extract(data, values)) {
+        for (int i = 0; i < pattern.parseFields.size(); ++i) {
+            metadata.set(pattern.parseFields.at(i).slot, values.at(i), m_strings);
+        }
+        if (fieldValues) {
+            *fieldValues = std::move(values);
+        }
+        return metadata;
+    }
 
-    // 如果解析失败，尝试检查并修复JSON格式
+    // 在同一份数据上修复常见的损坏（多余的括号、截断的结尾），再完整解析一次
+    TolerantJsonReader::Result repaired = TolerantJsonReader::read(data);
+    if (!repaired.ok) {
+        emit scanLog(tr("[ERROR] JSON无法修复，跳过此文件: %1 (%2)").arg(entryPath, repaired.error));
+        return metadata;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(repaired.data, &parseError);
     if (parseError.error != QJsonParseError::NoError) {
-        emit scanLog(tr("[WARNING] JSON解析失败，尝试自动修复: %1").arg(entryPath));
-        emit scanLog(tr("错误: %1").arg(parseError.errorString()));
+        emit scanLog(tr("[ERROR] JSON修复失败，跳过此文件: %1 (%2)").arg(entryPath, parseError.errorString()));
+        return metadata;
+    }
 
-        if (validateAndRepairJson(entryPath, doc)) {
-            emit scanLog(tr("[SUCCESS] JSON修复成功"));
-        } else {
-            emit scanLog(tr("[ERROR] JSON修复失败，跳过此文件"));
-            return metadata;
+    if (repaired.repaired()) {
+        emit scanLog(tr("[WARNING] 已修复损坏的JSON: %1 (%2)").arg(entryPath, repaired.repairs.join(tr("；"))));
+        if (m_config.writeRepairedJson) {
+            QString error;
+            if (writeRepairedJson(entryPath, repaired.data, &error)) {
+                emit scanLog(tr("[SUCCESS] 已写回修复后的文件: %1").arg(entryPath));
+            } else {
+                emit scanLog(tr("[WARNING] 写回修复后的文件失败: %1 (%2)").arg(entryPath, error));
+            }
         }
     }
 
@@ -389,41 +381,34 @@ QVariantMap FileScanner::extractMetadata(const QString &entryPath, const QVarian
 
     QJsonObject jsonObj = doc.object();
 
-    // 根据parse规则提取元数据
-    for (auto it = parseRules.begin(); it != parseRules.end(); ++it) {
-        QString field = it.key();
-        QString jsonPath = it.value().toString();
+    // 根据预先切分好的parse字段提取元数据
+    for (const CompiledPattern::Field &field : pattern.parseFields) {
+        metadata.set(field.slot, field.path.lookup(jsonObj).toVariant(), m_strings);
+    }
 
-        if (!jsonPath.isEmpty()) {
-            QVariant value = getValueFromJsonPath(jsonObj, jsonPath);
-            if (!value.isNull()) {
-                metadata[field] = value;
-            }
+    if (fieldValues) {
+        fieldValues->clear();
+        for (const JsonFieldPath &path : pattern.entryFields) {
+            fieldValues->append(path.lookup(jsonObj).toVariant());
         }
     }
 
     return metadata;
 }
 
-QVariant FileScanner::getValueFromJsonPath(const QJsonObject &jsonObj, const QString &path) const
+bool FileScanner::writeRepairedJson(const QString &filePath, const QByteArray &data, QString *error)
 {
-    if (path.isEmpty()) {
-        return QVariant();
+    // 先写临时文件再替换，中途失败时原文件保持不变
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        *error = file.errorString();
+        return false;
     }
-
-    // 处理多级路径，如 "page_data-cid"
-    QStringList parts = path.split('-');
-    QJsonValue current = jsonObj;
-
-    for (const QString &part : parts) {
-        if (current.isObject()) {
-            current = current.toObject().value(part);
-        } else {
-            return QVariant(); // 路径无效
-        }
+    if (file.write(data) != data.size() || !file.commit()) {
+        *error = file.errorString();
+        return false;
     }
-
-    return current.toVariant();
+    return true;
 }
 
 bool FileScanner::validateFilePath(const QString &filePath) const
@@ -432,13 +417,28 @@ bool FileScanner::validateFilePath(const QString &filePath) const
     return fileInfo.exists() && fileInfo.isFile();
 }
 
-bool FileScanner::validateMediaFile(const QString &filePath) const
+bool FileScanner::validateMediaFile(const QString &filePath, QString *reason) const
 {
     // 首先检查文件是否存在
     if (!validateFilePath(filePath)) {
         return false;
     }
 
+    // 能用ffprobe时以实际探测结果为准（结果会缓存，合并时不再重复探测）
+    if (m_mediaInfo && m_mediaInfo->isAvailable()) {
+        MediaInfo info = m_mediaInfo->info(filePath);
+        if (info.probed) {
+            if (!info.valid || info.truncated) {
+                if (reason) {
+                    *reason = info.error.isEmpty() ? tr("没有可用的音视频流")
+                                                   : info.error.section('\n', 0, 0);
+                }
+                return false;
+            }
+            return true;
+        }
+    }
+
     QFileInfo fileInfo(filePath);
     QString fileName = fileInfo.fileName().toLower();
 
@@ -484,12 +484,83 @@ bool FileScanner::validateMediaFile(const QString &filePath) const
     return false;
 }
 
-bool FileScanner::hasValidMediaPair(const VideoFile &videoFile) const
+void FileScanner::validateMediaFiles()
 {
+    // 每个文件一次ffprobe，彼此独立：先并行探测把结果放进缓存，下面按扫描顺序逐个检查时直接命中
+    if (m_mediaInfo && m_mediaInfo->isAvailable()) {
+        QStringList paths;
+        for (const VideoGroup &group : std::as_const(m_videoGroups)) {
+            for (const VideoFile &videoFile : group.files) {
+                if (videoFile.isBlvFormat) {
+                    paths << videoFile.blvFiles;
+                } else {
+                    paths << videoFile.videoPath << videoFile.audioPath;
+                }
+            }
+        }
+
+        TraceSpan span(m_trace, "scan.probe_media");
+        MediaInfoCache *cache = m_mediaInfo;
+        QtConcurrent::blockingMap(paths, [cache](const QString &path) {
+            cache->info(path);
+        });
+    }
+
+    m_totalFiles = 0;
+    m_totalGroups = 0;
+    for (auto group = m_videoGroups.begin(); group != m_videoGroups.end();) {
+        for (auto file = group->files.begin(); file != group->files.end();) {
+            if (hasValidMediaPair(*file)) {
+                ++file;
+            } else {
+                emit scanLog(tr("跳过无效的媒体文件对: %1").arg(file->entryPath));
+                file = group->files.erase(file);
+            }
+        }
+
+        if (group->files.isEmpty()) {
+            group = m_videoGroups.erase(group);
+        } else {
+            m_totalFiles += group->files.size();
+            m_totalGroups++;
+            ++group;
+        }
+    }
+}
+
+bool FileScanner::hasValidMediaPair(const VideoFile &videoFile)
+{
+    TraceSpan span(m_trace, "scan.validate_media", videoFile.entryPath);
+
+    // BLV的每个分段都要完整，任何一段截断都会让拼接结果缺失一截
+    if (videoFile.isBlvFormat) {
+        for (const QString &blvFile : videoFile.blvFiles) {
+            QString reason;
+            if (!validateMediaFile(blvFile, &reason)) {
+                emit scanLog(tr("[WARNING] BLV分段损坏或不完整: %1 (%2)")
+                             .arg(blvFile, reason.isEmpty() ? tr("不是有效的BLV文件") : reason));
+                return false;
+            }
+        }
+        return true;
+    }
+
     // 检查视频文件是否有效
-    bool videoValid = validateMediaFile(videoFile.videoPath);
+    QString videoReason;
+    bool videoValid = validateMediaFile(videoFile.videoPath, &videoReason);
     // 检查音频文件是否有效
-    bool audioValid = validateMediaFile(videoFile.audioPath);
+    QString audioReason;
+    bool audioValid = validateMediaFile(videoFile.audioPath, &audioReason);
+
+    // 文件存在但已损坏（多为下载中断），合并必然失败，扫描时直接排除
+    if (!videoReason.isEmpty()) {
+        emit scanLog(tr("[WARNING] 视频文件损坏或不完整: %1 (%2)").arg(videoFile.videoPath, videoReason));
+        return false;
+    }
+    if (!audioReason.isEmpty()) {
+        emit scanLog(tr("[WARNING] 音频文件损坏或不完整: %1 (%2)").arg(videoFile.audioPath, audioReason));
+        return false;
+    }
 
     // 至少需要视频或音频文件中的一个有效
     // 在B站缓存中，有时可能只有视频或只有音频
@@ -505,33 +576,6 @@ bool FileScanner::isBLVFile(const QString &filePath) const
     return fileName.endsWith(".blv");
 }
 
-QStringList FileScanner::findBLVSequence(const QDir &dir, const QString &prefix) const
-{
-    QStringList blvFiles;
-    QStringList filters;
-    filters << QString("%1*.blv").arg(prefix);
-
-    QStringList entries = dir.entryList(filters, QDir::Files | QDir::Readable, QDir::Name);
-
-    // 提取序号并排序
-    QMap<int, QString> numberedFiles;
-    for (const QString &fileName : entries) {
-        QRegularExpression regex(QString("%1(\\d+)\\.blv").arg(QRegularExpression::escape(prefix)));
-        QRegularExpressionMatch match = regex.match(fileName);
-        if (match.hasMatch()) {
-            int number = match.captured(1).toInt();
-            numberedFiles[number] = fileName;
-        }
-    }
-
-    // 返回排序后的文件列表
-    for (auto it = numberedFiles.begin(); it != numberedFiles.end(); ++it) {
-        blvFiles.append(dir.absoluteFilePath(it.value()));
-    }
-
-    return blvFiles;
-}
-
 bool FileScanner::checkBLVFile(const QString &filePath) const
 {
     QFile file(filePath);
@@ -548,142 +592,71 @@ bool FileScanner::checkBLVFile(const QString &filePath) const
     return header.size() > 0;
 }
 
-void FileScanner::processBLVFiles(VideoFile &videoFile, const QString &directory) const
+bool FileScanner::indexBLVSegments(VideoFile &videoFile, const QFileInfoList &entries, QString *reason) const
 {
-    QDir dir(directory);
-    QString entryFileName = QFileInfo(videoFile.entryPath).baseName();
-
-    // 查找所有BLV文件（通常命名为 entry.blv, entry_1.blv 等）
-    QStringList blvFiles = findBLVSequence(dir, entryFileName + "_");
-
-    // 如果没有找到带序号的，尝试直接匹配
-    if (blvFiles.isEmpty()) {
-        QString directBlv = dir.absoluteFilePath(entryFileName + ".blv");
-        if (QFile::exists(directBlv)) {
-            blvFiles.append(directBlv);
+    // 分段命名为 <entry名>_<序号>.blv，只有一段时也可能是 <entry名>.blv
+    const QString baseName = QFileInfo(videoFile.entryPath).baseName();
+    const int prefixLength = baseName.size() + 1;
+
+    QString directPath;
+    QVector<QPair<int, QString>> segments;
+    int minNumber = INT_MAX;
+    int maxNumber = -1;
+    for (const QFileInfo &entry : entries) {
+        const QString fileName = entry.fileName();
+        if (!fileName.endsWith(QLatin1String(".blv"), Qt::CaseInsensitive) || !fileName.startsWith(baseName)) {
+            continue;
         }
-    }
-
-    videoFile.isBlvFormat = !blvFiles.isEmpty();
-    videoFile.blvFiles = blvFiles;
-
-    if (videoFile.isBlvFormat) {
-        videoFile.blvPath = blvFiles.first(); // 主BLV文件
-    }
-}
-
-bool FileScanner::validateAndRepairJson(const QString &filePath, QJsonDocument &doc)
-{
-    QString fixedContent;
-    if (checkAndFixJsonFormat(filePath, fixedContent)) {
-        QJsonParseError error;
-        doc = QJsonDocument::fromJson(fixedContent.toUtf8(), &error);
 
-        if (error.error == QJsonParseError::NoError) {
-            return true;
+        const int stemLength = fileName.size() - 4;
+        if (stemLength == baseName.size()) {
+            directPath = entry.absoluteFilePath();
+            continue;
+        }
+        if (stemLength <= prefixLength || fileName.at(baseName.size()) != '_') {
+            continue;
         }
-    }
-
-    return false;
-}
-
-bool FileScanner::checkAndFixJsonFormat(const QString &filePath, QString &fixedContent)
-{
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        emit scanLog(tr("[WARNING] 无法打开JSON文件: %1").arg(filePath));
-        return false;
-    }
-
-    QTextStream stream(&file);
-    QString content = stream.readAll();
-    file.close();
-
-    // 尝试直接解析JSON
-    QJsonParseError error;
-    QJsonDocument::fromJson(content.toUtf8(), &error);
-
-    // 如果解析成功，直接返回
-    if (error.error == QJsonParseError::NoError) {
-        fixedContent = content;
-        return true;
-    }
-
-    emit scanLog(tr("[WARNING] 检测到损坏的JSON文件: %1").arg(filePath));
-    emit scanLog(tr("错误类型: %1").arg(error.errorString()));
-    emit scanLog(tr("尝试自动修复..."));
-
-    // 尝试修复JSON格式
-    fixJsonContent(content);
-
-    // 再次验证
-    error = QJsonParseError();
-    QJsonDocument::fromJson(content.toUtf8(), &error);
-
-    if (error.error == QJsonParseError::NoError) {
-        emit scanLog(tr("[SUCCESS] JSON文件修复成功"));
 
-        // 询问用户是否保存修复后的文件
-        // TODO: 可以添加一个选项自动保存
-        fixedContent = content;
-        return true;
-    } else {
-        emit scanLog(tr("[ERROR] JSON文件修复失败: %1").arg(error.errorString()));
-        return false;
+        int number = segmentNumber(QStringView(fileName).mid(prefixLength, stemLength - prefixLength));
+        if (number < 0) {
+            continue;
+        }
+        segments.append(qMakePair(number, entry.absoluteFilePath()));
+        minNumber = qMin(minNumber, number);
+        maxNumber = qMax(maxNumber, number);
     }
-}
 
-void FileScanner::fixJsonContent(QString &content)
-{
-    // 根据Python版本的jsonCheck实现，主要修复多余的"}"字符
-
-    // 统计左大括号和右大括号
-    int leftBraces = content.count('{');
-    int rightBraces = content.count('}');
-
-    // 如果右大括号比左大括号多，说明有多余的右括号
-    if (rightBraces > leftBraces) {
-        emit scanLog(tr("检测到 %1 个多余的右大括号，尝试移除...").arg(rightBraces - leftBraces));
-
-        // 移除多余的右括号
-        // 从后往前删除多余的"}"字符
-        for (int i = 0; i < rightBraces - leftBraces; ++i) {
-            int lastIndex = content.lastIndexOf('}');
-            if (lastIndex != -1) {
-                content.remove(lastIndex, 1);
-            }
+    QStringList blvFiles;
+    if (!segments.isEmpty()) {
+        // 序号连续时按 序号-最小序号 直接放入对应位置，无需排序
+        const int count = segments.size();
+        if (minNumber > 1) {
+            *reason = tr("缺少第 %1 段之前的分段").arg(minNumber);
+            return false;
+        }
+        if (maxNumber - minNumber + 1 != count) {
+            *reason = tr("分段序号不连续（%1 个分段，序号 %2-%3）").arg(count).arg(minNumber).arg(maxNumber);
+            return false;
         }
-    }
-    // 如果左大括号比右大括号多，说明缺少右括号
-    else if (leftBraces > rightBraces) {
-        emit scanLog(tr("检测到缺少 %1 个右大括号，尝试补全...").arg(leftBraces - rightBraces));
 
-        // 在文件末尾补全缺少的右括号
-        for (int i = 0; i < leftBraces - rightBraces; ++i) {
-            content.append("\n}");
+        QVector<QString> ordered(count);
+        for (const auto &segment : segments) {
+            QString &slot = ordered[segment.first - minNumber];
+            if (!slot.isEmpty()) {
+                *reason = tr("分段序号 %1 重复").arg(segment.first);
+                return false;
+            }
+            slot = segment.second;
         }
+        blvFiles = QStringList(ordered.begin(), ordered.end());
+    } else if (!directPath.isEmpty()) {
+        blvFiles.append(directPath);
     }
 
-    // 尝试查找更复杂的格式错误
-    // 例如：多个连续的右括号 }}
-    content.replace("}}", "}");
-
-    // 尝试修复常见的JSON格式问题
-    // 移除末尾多余的逗号
-    content.replace(QRegularExpression(",\\s*}"), "}");
-    content.replace(QRegularExpression(",\\s*]"), "]");
-
-    // 确保文件以正确的字符结尾
-    content = content.trimmed();
-    if (!content.endsWith('}') && !content.endsWith(']')) {
-        content.append("\n}");
+    videoFile.isBlvFormat = !blvFiles.isEmpty();
+    videoFile.blvFiles = blvFiles;
+    if (videoFile.isBlvFormat) {
+        videoFile.blvPath = blvFiles.first(); // 主BLV文件
     }
-}
-
-QString FileScanner::findMatchingBrace(const QString &content, int startPos) const
-{
-    Q_UNUSED(content);
-    Q_UNUSED(startPos);
-    // 这个方法为将来扩展预留，当前版本主要处理简单的多余括号问题
-    return QString();
+    return true;
 }
@@ -10,9 +10,13 @@
 #include <QList>
 #include <QString>
 #include <QRegularExpression>
+#include "CompiledPattern.h"
+#include "VideoMetadata.h"
 
 class PatternManager;
 class ConfigManager;
+class TraceRecorder;
+class MediaInfoCache;
 
 /**
  * @brief 文件扫描器类
@@ -41,9 +45,10 @@ public:
         bool coverEnabled;
         bool subtitleEnabled;
         bool ordered;
+        bool writeRepairedJson = false;     // 把修复后的entry文件写回磁盘
     };
 
-    // 扫描结果结构
+    // 扫描结果结构：元数据为定长字段，字符串均为隐式共享，记录在各阶段之间移动而不复制
     struct VideoFile {
         QString entryPath;
         QString videoPath;
@@ -52,8 +57,8 @@ public:
         QString coverPath;
         QString blvPath;              // BLV文件路径（PC客户端格式）
         QStringList blvFiles;         // BLV分段文件列表
-        bool isBlvFormat;             // 是否为BLV格式
-        QVariantMap metadata;
+        bool isBlvFormat = false;     // 是否为BLV格式
+        VideoMetadata metadata;
     };
 
     struct VideoGroup {
@@ -61,12 +66,20 @@ public:
         QString groupEntryPath;
         QString coverPath;
         QList<VideoFile> files;
-        QVariantMap groupMetadata;
+        QString title;                // 组标题；非分组模式下与唯一分集的标题共用
     };
 
+    // 分阶段耗时记录（可选）
+    void setTraceRecorder(TraceRecorder *recorder);
+
+    // 媒体信息缓存（可选），设置后用ffprobe校验媒体文件，能发现下载不完整的文件
+    void setMediaInfoCache(MediaInfoCache *cache);
+
     // 扫描方法
     bool scan(const ScanConfig &config);
-    QList<VideoGroup> videoGroups() const;
+    const QList<VideoGroup> &videoGroups() const;
+    // 移交扫描结果，之后videoGroups()为空；合并线程用它接管结果，不产生拷贝
+    QList<VideoGroup> takeVideoGroups();
     int totalFiles() const;
     int totalGroups() const;
 
@@ -77,31 +90,33 @@ signals:
     void scanLog(const QString &message);
 
 private:
-    bool scanDirectory(const QString &path, const QVariantMap &pattern);
-    bool isEntryFile(const QString &filePath, const QVariantMap &pattern);
-    QString resolvePathTemplate(const QString &templateStr, const QString &entryPath, const QVariantMap &pattern);
-    QVariantMap extractMetadata(const QString &entryPath, const QVariantMap &parseRules);
-    QVariant getValueFromJsonPath(const QJsonObject &jsonObj, const QString &path) const;
+    bool scanDirectory(const QString &path, const CompiledPattern &pattern);
+    bool isEntryFile(const QString &filePath, const CompiledPattern &pattern);
+    // fieldValues不为空时按pattern.entryFields的顺序返回各字段的值，供路径模板使用
+    VideoMetadata extractMetadata(const QString &entryPath, const CompiledPattern &pattern,
+                                  QVector<QVariant> *fieldValues = nullptr);
     bool validateFilePath(const QString &filePath) const;
-    bool validateMediaFile(const QString &filePath) const;
-    bool hasValidMediaPair(const VideoFile &videoFile) const;
+    bool validateMediaFile(const QString &filePath, QString *reason = nullptr) const;
+    bool hasValidMediaPair(const VideoFile &videoFile);
+    // 遍历结束后校验全部媒体文件，去掉无效的分集和因此变空的组
+    void validateMediaFiles();
 
-    // JSON检查和修复
-    bool validateAndRepairJson(const QString &filePath, QJsonDocument &doc);
-    bool checkAndFixJsonFormat(const QString &filePath, QString &fixedContent);
-    void fixJsonContent(QString &content);
-    QString findMatchingBrace(const QString &content, int startPos) const;
+    // 原子地写回修复后的JSON
+    bool writeRepairedJson(const QString &filePath, const QByteArray &data, QString *error);
 
     // BLV格式支持
     bool isBLVFile(const QString &filePath) const;
-    QStringList findBLVSequence(const QDir &dir, const QString &prefix) const;
     bool checkBLVFile(const QString &filePath) const;
-    void processBLVFiles(VideoFile &videoFile, const QString &directory) const;
+    // 从已列出的目录条目中找出entry对应的BLV分段并按序号排列；序号有缺口或重复时返回false
+    bool indexBLVSegments(VideoFile &videoFile, const QFileInfoList &entries, QString *reason) const;
 
     ConfigManager* m_configManager;
     PatternManager* m_patternManager;
+    TraceRecorder* m_trace;
+    MediaInfoCache* m_mediaInfo;
     ScanConfig m_config;
     QList<VideoGroup> m_videoGroups;
+    StringPool m_strings;           // 元数据字符串驻留，仅扫描期间使用
     int m_totalFiles;
     int m_totalGroups;
     QRegularExpression m_invalidCharsRegex;
@@ -0,0 +1,419 @@
+#include "JsonFieldExtractor.h"
+#include "CompiledPattern.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstring>
+
+JsonFieldExtractor::JsonFieldExtractor()
+    : m_nodes(1)
+    , m_fieldCount(0)
+{
+}
+
+JsonFieldExtractor::JsonFieldExtractor(const QVector<JsonFieldPath> &paths)
+    : m_nodes(1)
+    , m_fieldCount(paths.size())
+    , m_sourceField(paths.size(), -1)
+{
+    for (int field = 0; field < paths.size(); ++field) {
+        if (paths.at(field).isEmpty()) {
+            continue;
+        }
+
+        int node = 0;
+        for (const QString &key : paths.at(field).keys) {
+            QByteArray name = key.toUtf8();
+            int child = m_nodes[node].children.value(name, -1);
+            if (child < 0) {
+                child = m_nodes.size();
+                m_nodes.append(Node());
+                m_nodes[node].children.insert(name, child);
+            }
+            node = child;
+        }
+        // 同一路径重复出现时只取一次，其余字段在extract()末尾复制
+        if (m_nodes[node].field < 0) {
+            m_nodes[node].field = field;
+        }
+        m_sourceField[field] = m_nodes[node].field;
+    }
+}
+
+int JsonFieldExtractor::fieldCount() const
+{
+    return m_fieldCount;
+}
+
+bool JsonFieldExtractor::extract(const QByteArray &data, QVector<QVariant> &values, QString *error) const
+{
+    values = QVector<QVariant>(m_fieldCount);
+
+    Cursor cursor;
+    cursor.pos = data.constData();
+    cursor.end = data.constData() + data.size();
+    cursor.values = &values;
+    cursor.found = QVector<bool>(m_fieldCount, false);
+    cursor.done = false;
+
+    // 只统计实际挂在树上的字段，重复路径不计
+    cursor.remaining = 0;
+    for (const Node &node : m_nodes) {
+        if (node.field >= 0) {
+            cursor.remaining++;
+        }
+    }
+
+    // UTF-8 BOM
+    if (data.size() >= 3 && data.startsWith("\xEF\xBB\xBF")) {
+        cursor.pos += 3;
+    }
+
+    skipWhitespace(cursor);
+    bool ok = false;
+    if (cursor.pos >= cursor.end || *cursor.pos != '{') {
+        fail(cursor, "根节点不是对象");
+    } else if (cursor.remaining == 0) {
+        ok = true;
+    } else {
+        ok = readObject(cursor, 0) || cursor.done;
+    }
+
+    if (!ok && error) {
+        *error = cursor.error;
+    }
+
+    // 重复的路径共用同一个值
+    for (int field = 0; field < m_fieldCount; ++field) {
+        int source = m_sourceField.at(field);
+        if (source >= 0 && source != field) {
+            values[field] = values.at(source);
+        }
+    }
+
+    return ok;
+}
+
+bool JsonFieldExtractor::readObject(Cursor &cursor, int node) const
+{
+    // 调用时cursor.pos指向'{'
+    ++cursor.pos;
+    skipWhitespace(cursor);
+    if (cursor.pos < cursor.end && *cursor.pos == '}') {
+        ++cursor.pos;
+        return true;
+    }
+
+    const Node &current = m_nodes.at(node);
+    QByteArray key;
+    for (;;) {
+        skipWhitespace(cursor);
+        if (!readKey(cursor, key)) {
+            return false;
+        }
+        skipWhitespace(cursor);
+        if (cursor.pos >= cursor.end || *cursor.pos != ':') {
+            return fail(cursor, "缺少冒号");
+        }
+        ++cursor.pos;
+        skipWhitespace(cursor);
+        if (cursor.pos >= cursor.end) {
+            return fail(cursor, "文件意外结束");
+        }
+
+        int child = current.children.value(key, -1);
+        if (child < 0) {
+            if (!skipValue(cursor)) {
+                return false;
+            }
+        } else {
+            const Node &target = m_nodes.at(child);
+            bool wanted = target.field >= 0 && !cursor.found.at(target.field);
+            const char *valueStart = cursor.pos;
+
+            if (!target.children.isEmpty() && *cursor.pos == '{') {
+                // 继续向下查找更深的字段
+                if (!readObject(cursor, child)) {
+                    return false;
+                }
+                if (wanted) {
+                    // 路径本身也被请求：单独解析这一段对象
+                    QByteArray slice(valueStart, int(cursor.pos - valueStart));
+                    (*cursor.values)[target.field] = QJsonDocument::fromJson(slice).object().toVariantMap();
+                }
+            } else if (wanted) {
+                if (!readValue(cursor, (*cursor.values)[target.field])) {
+                    return false;
+                }
+            } else if (!skipValue(cursor)) {
+                return false;
+            }
+
+            if (wanted) {
+                cursor.found[target.field] = true;
+                if (--cursor.remaining == 0) {
+                    // 所需字段已全部取到，后面的内容（即使已损坏）不再读取
+                    cursor.done = true;
+                    return false;
+                }
+            }
+        }
+
+        skipWhitespace(cursor);
+        if (cursor.pos >= cursor.end) {
+            return fail(cursor, "文件意外结束");
+        }
+        if (*cursor.pos == ',') {
+            ++cursor.pos;
+            continue;
+        }
+        if (*cursor.pos == '}') {
+            ++cursor.pos;
+            return true;
+        }
+        return fail(cursor, "对象成员之间缺少逗号");
+    }
+}
+
+bool JsonFieldExtractor::readValue(Cursor &cursor, QVariant &value)
+{
+    const char *start = cursor.pos;
+    char ch = *start;
+
+    if (ch == '"') {
+        if (!skipString(cursor)) {
+            return false;
+        }
+        value = decodeString(start + 1, cursor.pos - 1);
+        return true;
+    }
+
+    if (ch == '{' || ch == '[') {
+        // 字段本身是对象或数组：只解析这一段
+        if (!skipValue(cursor)) {
+            return false;
+        }
+        QJsonDocument doc = QJsonDocument::fromJson(QByteArray(start, int(cursor.pos - start)));
+        if (doc.isObject()) {
+            value = doc.object().toVariantMap();
+        } else if (doc.isArray()) {
+            value = doc.array().toVariantList();
+        }
+        return true;
+    }
+
+    qptrdiff left = cursor.end - start;
+    if (left >= 4 && std::memcmp(start, "true", 4) == 0) {
+        value = true;
+        cursor.pos += 4;
+        return true;
+    }
+    if (left >= 5 && std::memcmp(start, "false", 5) == 0) {
+        value = false;
+        cursor.pos += 5;
+        return true;
+    }
+    if (left >= 4 && std::memcmp(start, "null", 4) == 0) {
+        value = QVariant();
+        cursor.pos += 4;
+        return true;
+    }
+
+    // 数字：不含小数点和指数时按整数处理，超出范围再退回double
+    bool isDouble = false;
+    const char *pos = start;
+    while (pos < cursor.end) {
+        char c = *pos;
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+') {
+            ++pos;
+        } else if (c == '.' || c == 'e' || c == 'E') {
+            isDouble = true;
+            ++pos;
+        } else {
+            break;
+        }
+    }
+    if (pos == start) {
+        return fail(cursor, "无法识别的值");
+    }
+
+    QByteArray number(start, int(pos - start));
+    bool ok = false;
+    if (!isDouble) {
+        qlonglong integer = number.toLongLong(&ok);
+        if (ok) {
+            value = integer;
+        }
+    }
+    if (!ok) {
+        double real = number.toDouble(&ok);
+        if (!ok) {
+            return fail(cursor, "无效的数字");
+        }
+        value = real;
+    }
+    cursor.pos = pos;
+    return true;
+}
+
+bool JsonFieldExtractor::skipValue(Cursor &cursor)
+{
+    // 不递归：只按括号深度跳过，字符串内的括号不计
+    int depth = 0;
+    do {
+        skipWhitespace(cursor);
+        if (cursor.pos >= cursor.end) {
+            return fail(cursor, "文件意外结束");
+        }
+
+        char ch = *cursor.pos;
+        if (ch == '"') {
+            if (!skipString(cursor)) {
+                return false;
+            }
+        } else if (ch == '{' || ch == '[') {
+            ++depth;
+            ++cursor.pos;
+        } else if (ch == '}' || ch == ']') {
+            if (depth == 0) {
+                return fail(cursor, "多余的右括号");
+            }
+            --depth;
+            ++cursor.pos;
+        } else if (ch == ',' || ch == ':') {
+            if (depth == 0) {
+                return fail(cursor, "缺少值");
+            }
+            ++cursor.pos;
+        } else {
+            // 数字或true/false/null
+            const char *start = cursor.pos;
+            while (cursor.pos < cursor.end) {
+                char c = *cursor.pos;
+                if (c == ',' || c == '}' || c == ']' || c == ':' || c == '"'
+                    || c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                    break;
+                }
+                ++cursor.pos;
+            }
+            if (cursor.pos == start) {
+                return fail(cursor, "无法识别的值");
+            }
+        }
+    } while (depth > 0);
+
+    return true;
+}
+
+bool JsonFieldExtractor::skipString(Cursor &cursor)
+{
+    // 调用时cursor.pos指向开头的引号，返回时指向结尾引号之后
+    const char *from = cursor.pos + 1;
+    for (;;) {
+        const void *hit = std::memchr(from, '"', size_t(cursor.end - from));
+        if (!hit) {
+            return fail(cursor, "字符串没有结束");
+        }
+        const char *quote = static_cast<const char *>(hit);
+
+        // 前面有奇数个反斜杠时是转义的引号
+        int backslashes = 0;
+        for (const char *p = quote - 1; p > cursor.pos && *p == '\\'; --p) {
+            ++backslashes;
+        }
+        if (backslashes % 2 == 0) {
+            cursor.pos = quote + 1;
+            return true;
+        }
+        from = quote + 1;
+    }
+}
+
+bool JsonFieldExtractor::readKey(Cursor &cursor, QByteArray &key)
+{
+    if (cursor.pos >= cursor.end || *cursor.pos != '"') {
+        return fail(cursor, "缺少键名");
+    }
+    const char *start = cursor.pos + 1;
+    if (!skipString(cursor)) {
+        return false;
+    }
+    const char *stop = cursor.pos - 1;
+
+    // 键名极少含转义，没有时直接比较原始字节
+    if (std::memchr(start, '\\', size_t(stop - start))) {
+        key = decodeString(start, stop).toUtf8();
+    } else {
+        key = QByteArray::fromRawData(start, int(stop - start));
+    }
+    return true;
+}
+
+QString JsonFieldExtractor::decodeString(const char *begin, const char *end)
+{
+    if (!std::memchr(begin, '\\', size_t(end - begin))) {
+        return QString::fromUtf8(begin, int(end - begin));
+    }
+
+    QString result;
+    result.reserve(int(end - begin));
+    const char *run = begin;
+    const char *pos = begin;
+    while (pos < end) {
+        if (*pos != '\\') {
+            ++pos;
+            continue;
+        }
+
+        result += QString::fromUtf8(run, int(pos - run));
+        ++pos;
+        if (pos >= end) {
+            break;
+        }
+
+        char escaped = *pos++;
+        switch (escaped) {
+        case 'b': result += QChar('\b'); break;
+        case 'f': result += QChar('\f'); break;
+        case 'n': result += QChar('\n'); break;
+        case 'r': result += QChar('\r'); break;
+        case 't': result += QChar('\t'); break;
+        case 'u':
+            if (end - pos >= 4) {
+                bool ok = false;
+                ushort code = QByteArray(pos, 4).toUShort(&ok, 16);
+                if (ok) {
+                    // 代理对由前后两个\u组成，逐个追加即可拼成完整字符
+                    result += QChar(code);
+                }
+                pos += 4;
+            }
+            break;
+        default:
+            result += QChar::fromLatin1(escaped);
+            break;
+        }
+        run = pos;
+    }
+    result += QString::fromUtf8(run, int(end - run));
+    return result;
+}
+
+void JsonFieldExtractor::skipWhitespace(Cursor &cursor)
+{
+    while (cursor.pos < cursor.end) {
+        char c = *cursor.pos;
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            break;
+        }
+        ++cursor.pos;
+    }
+}
+
+bool JsonFieldExtractor::fail(Cursor &cursor, const char *message)
+{
+    if (cursor.error.isEmpty()) {
+        cursor.error = QString::fromUtf8(message);
+    }
+    return false;
+}
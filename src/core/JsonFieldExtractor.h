@@ -0,0 +1,65 @@
+#ifndef JSONFIELDEXTRACTOR_H
+#define JSONFIELDEXTRACTOR_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+struct JsonFieldPath;
+
+/**
+ * @brief 按需提取JSON字段
+ * 构造时把要取的字段路径建成一棵按键名分支的树，提取时只扫描一遍原始字节：
+ * 不在树上的键整段跳过（不解码、不建对象），所需字段全部取到后立即返回
+ *
+ * entry.json中常有很大的分段或弹幕数组，而模式只需要其中十来个字段
+ * 取值类型与QJsonValue::toVariant()一致：字符串、bool、整数为qlonglong、小数为double，
+ * 字段本身是对象或数组时才单独解析该片段；null和缺失的字段为无效QVariant
+ *
+ * 可在多个线程中同时调用extract()
+ */
+class JsonFieldExtractor
+{
+public:
+    JsonFieldExtractor();
+    explicit JsonFieldExtractor(const QVector<JsonFieldPath> &paths);
+
+    int fieldCount() const;
+
+    // values按构造时的顺序返回各字段的值
+    // 在取全字段之前遇到语法错误（或根不是对象）时返回false，此时values中已取到的值仍然有效
+    bool extract(const QByteArray &data, QVector<QVariant> &values, QString *error = nullptr) const;
+
+private:
+    struct Node {
+        QHash<QByteArray, int> children;   // 键名（UTF-8）-> 子节点下标
+        int field = -1;                     // 路径在此结束时对应的字段下标
+    };
+
+    struct Cursor {
+        const char *pos;
+        const char *end;
+        QVector<QVariant> *values;
+        QVector<bool> found;
+        int remaining;
+        bool done;
+        QString error;
+    };
+
+    bool readObject(Cursor &cursor, int node) const;
+    static bool readValue(Cursor &cursor, QVariant &value);
+    static bool skipValue(Cursor &cursor);
+    static bool skipString(Cursor &cursor);
+    static bool readKey(Cursor &cursor, QByteArray &key);
+    static QString decodeString(const char *begin, const char *end);
+    static void skipWhitespace(Cursor &cursor);
+    static bool fail(Cursor &cursor, const char *message);
+
+    QVector<Node> m_nodes;      // m_nodes[0]为根对象
+    int m_fieldCount;
+    QVector<int> m_sourceField; // 每个字段实际取值的字段（路径重复时指向第一次出现的），空路径为-1
+};
+
+#endif // JSONFIELDEXTRACTOR_H
@@ -0,0 +1,317 @@
+#include "LogFileSink.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QStringList>
+#include <array>
+
+namespace {
+
+const int kQueueCapacity = 16384;
+const int kDrainBatch = 4096;
+
+quint32 crc32(const QByteArray &data)
+{
+    static const std::array<quint32, 256> table = []() {
+        std::array<quint32, 256> result{};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            result[i] = c;
+        }
+        return result;
+    }();
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (char byte : data) {
+        crc = table[(crc ^ quint8(byte)) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void appendLittleEndian(QByteArray &out, quint32 value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out.append(char((value >> (8 * i)) & 0xFF));
+    }
+}
+
+} // namespace
+
+std::atomic<LogFileSink *> LogFileSink::s_handlerSink(nullptr);
+QtMessageHandler LogFileSink::s_previousHandler = nullptr;
+
+LogFileSink::LogFileSink(QObject *parent)
+    : QThread(parent)
+    , m_queue(kQueueCapacity)
+    , m_stopRequested(false)
+    , m_pending(0)
+    , m_droppedTotal(0)
+    , m_filePath(defaultFilePath())
+    , m_maxBytes(16 * 1024 * 1024)
+    , m_maxAgeSeconds(24 * 3600)
+    , m_keepFiles(5)
+    , m_compressRotated(true)
+    , m_flushIntervalMs(500)
+{
+}
+
+LogFileSink::~LogFileSink()
+{
+    // 先摘掉消息处理器，之后的qDebug不再进入队列
+    LogFileSink *expected = this;
+    if (s_handlerSink.compare_exchange_strong(expected, nullptr)) {
+        qInstallMessageHandler(s_previousHandler);
+    }
+
+    stop();
+    wait();
+}
+
+QString LogFileSink::defaultFilePath()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).filePath("bilimergelog.txt");
+}
+
+void LogFileSink::setFilePath(const QString &filePath)
+{
+    m_filePath = filePath;
+}
+
+QString LogFileSink::filePath() const
+{
+    return m_filePath;
+}
+
+void LogFileSink::setRotation(qint64 maxBytes, int maxAgeSeconds, int keepFiles)
+{
+    m_maxBytes = qMax<qint64>(64 * 1024, maxBytes);
+    m_maxAgeSeconds = qMax(0, maxAgeSeconds);
+    m_keepFiles = qMax(0, keepFiles);
+}
+
+void LogFileSink::setCompressRotated(bool enabled)
+{
+    m_compressRotated = enabled;
+}
+
+void LogFileSink::setFlushInterval(int msecs)
+{
+    m_flushIntervalMs = qMax(10, msecs);
+}
+
+void LogFileSink::write(const QString &message)
+{
+    QString line = QString("[%1] %2")
+        .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz"), message);
+    if (!m_queue.push(line)) {
+        return;
+    }
+
+    // 积压到一半时提前唤醒写线程，平时按刷新间隔批量写
+    if (m_pending.fetch_add(1) + 1 == m_queue.capacity() / 2) {
+        m_wake.wakeOne();
+    }
+}
+
+void LogFileSink::stop()
+{
+    m_stopRequested.store(true);
+    QMutexLocker locker(&m_wakeMutex);
+    m_wake.wakeOne();
+}
+
+quint64 LogFileSink::droppedCount() const
+{
+    return m_droppedTotal.load();
+}
+
+void LogFileSink::installMessageHandler()
+{
+    LogFileSink *expected = nullptr;
+    if (s_handlerSink.compare_exchange_strong(expected, this)) {
+        s_previousHandler = qInstallMessageHandler(&LogFileSink::messageHandler);
+    }
+}
+
+void LogFileSink::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    LogFileSink *sink = s_handlerSink.load();
+    if (sink) {
+        const char *level = "DEBUG";
+        switch (type) {
+        case QtInfoMsg: level = "INFO"; break;
+        case QtWarningMsg: level = "WARNING"; break;
+        case QtCriticalMsg: level = "ERROR"; break;
+        case QtFatalMsg: level = "FATAL"; break;
+        default: break;
+        }
+        sink->write(QString("[%1] %2").arg(QLatin1String(level), message));
+    }
+
+    if (s_previousHandler) {
+        s_previousHandler(type, context, message);
+    }
+}
+
+void LogFileSink::run()
+{
+    bool opened = openFile();
+
+    QStringList lines;
+    for (;;) {
+        {
+            QMutexLocker locker(&m_wakeMutex);
+            if (!m_stopRequested.load() && m_queue.isEmpty()) {
+                m_wake.wait(&m_wakeMutex, m_flushIntervalMs);
+            }
+        }
+
+        // 取出当前所有积压，合并成一次写入
+        lines.clear();
+        int taken = 0;
+        int count = 0;
+        while ((count = m_queue.drain(lines, kDrainBatch)) > 0) {
+            taken += count;
+        }
+        m_pending.fetch_sub(taken);
+
+        quint64 dropped = m_queue.takeDropped();
+        if (dropped > 0) {
+            m_droppedTotal.fetch_add(dropped);
+            lines.append(QString("[%1] [WARNING] 日志写入过快，丢弃了 %2 条")
+                         .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz"))
+                         .arg(dropped));
+        }
+
+        if (!lines.isEmpty()) {
+            QByteArray buffer;
+            for (const QString &line : lines) {
+                buffer += line.toUtf8();
+                buffer += '\n';
+            }
+
+            if (opened && needsRotation(buffer.size())) {
+                rotate();
+                opened = openFile();
+            }
+            if (opened) {
+                m_file.write(buffer);
+                m_file.flush();
+            }
+        }
+
+        if (m_stopRequested.load() && m_queue.isEmpty()) {
+            break;
+        }
+    }
+
+    m_file.close();
+}
+
+bool LogFileSink::openFile()
+{
+    QFileInfo info(m_filePath);
+    QDir().mkpath(info.absolutePath());
+
+    m_file.setFileName(m_filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return false;
+    }
+
+    // 已有文件按创建时间计算时限，取不到时从现在算起
+    m_openedAt = info.exists() && info.birthTime().isValid() ? info.birthTime() : QDateTime::currentDateTime();
+    return true;
+}
+
+bool LogFileSink::needsRotation(qint64 incomingBytes) const
+{
+    qint64 size = m_file.size();
+    if (size == 0) {
+        return false;
+    }
+    if (size + incomingBytes > m_maxBytes) {
+        return true;
+    }
+    return m_maxAgeSeconds > 0 && m_openedAt.secsTo(QDateTime::currentDateTime()) >= m_maxAgeSeconds;
+}
+
+void LogFileSink::rotate()
+{
+    m_file.close();
+
+    if (m_keepFiles == 0) {
+        QFile::remove(m_filePath);
+        return;
+    }
+
+    // name.N 被挤出，其余依次后移
+    QFile::remove(rotatedPath(m_keepFiles, false));
+    QFile::remove(rotatedPath(m_keepFiles, true));
+    for (int i = m_keepFiles - 1; i >= 1; --i) {
+        for (bool compressed : {false, true}) {
+            QString from = rotatedPath(i, compressed);
+            if (QFile::exists(from)) {
+                QFile::rename(from, rotatedPath(i + 1, compressed));
+            }
+        }
+    }
+
+    QString first = rotatedPath(1, false);
+    if (!QFile::rename(m_filePath, first)) {
+        QFile::remove(m_filePath);
+        return;
+    }
+
+    // 压缩在写线程中进行，期间新日志在队列中积压，不影响调用方
+    if (m_compressRotated && gzipFile(first, rotatedPath(1, true))) {
+        QFile::remove(first);
+    }
+}
+
+QString LogFileSink::rotatedPath(int index, bool compressed) const
+{
+    QFileInfo info(m_filePath);
+    QString name = info.completeSuffix().isEmpty()
+        ? QString("%1.%2").arg(info.baseName()).arg(index)
+        : QString("%1.%2.%3").arg(info.baseName()).arg(index).arg(info.completeSuffix());
+    if (compressed) {
+        name += ".gz";
+    }
+    return info.dir().filePath(name);
+}
+
+bool LogFileSink::gzipFile(const QString &sourcePath, const QString &targetPath)
+{
+    QFile source(sourcePath);
+    if (!source.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray data = source.readAll();
+    source.close();
+
+    // qCompress输出为4字节长度+zlib流（2字节头、deflate数据、4字节adler32），取出deflate数据改用gzip封装
+    QByteArray zlib = qCompress(data, 6);
+    if (zlib.size() < 10) {
+        return false;
+    }
+
+    QByteArray gzip;
+    gzip.reserve(zlib.size() + 12);
+    const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'};
+    gzip.append(header, sizeof(header));
+    gzip.append(zlib.constData() + 6, zlib.size() - 10);
+    appendLittleEndian(gzip, crc32(data));
+    appendLittleEndian(gzip, quint32(data.size()));
+
+    QFile target(targetPath);
+    if (!target.open(QIODevice::WriteOnly) || target.write(gzip) != gzip.size()) {
+        target.remove();
+        return false;
+    }
+    target.close();
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef LOGFILESINK_H
+#define LOGFILESINK_H
+
+#include <QThread>
+#include <QString>
+#include <QFile>
+#include <QDateTime>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include "LogRing.h"
+
+/**
+ * @brief 异步日志文件
+ * 调用方把带时间戳的日志行写入无锁队列后立即返回，由本线程批量追加到文件
+ *
+ * - write()从不阻塞：队列满时丢弃并计数，写线程在文件中补一行丢弃条数
+ * - 文件超过大小上限或打开时间超过时限时轮转为 name.1.ext、name.2.ext...，
+ *   可选压缩为 .gz，只保留指定个数
+ * - installMessageHandler()后qDebug/qWarning等也写入本文件
+ *
+ * 设置项须在start()之前调用；析构时写完队列中剩余的内容
+ */
+class LogFileSink : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit LogFileSink(QObject *parent = nullptr);
+    ~LogFileSink();
+
+    // 默认位置：应用数据目录下的bilimergelog.txt（日志查看器会查找该位置）
+    static QString defaultFilePath();
+
+    void setFilePath(const QString &filePath);
+    QString filePath() const;
+
+    // 轮转条件：文件大小上限、单个文件最长时间（秒，0为不按时间），保留的旧文件个数
+    void setRotation(qint64 maxBytes, int maxAgeSeconds, int keepFiles);
+    void setCompressRotated(bool enabled);
+
+    // 写线程最长多久落盘一次
+    void setFlushInterval(int msecs);
+
+    // 任意线程调用
+    void write(const QString &message);
+
+    // 写完剩余内容后结束线程
+    void stop();
+
+    quint64 droppedCount() const;
+
+    void installMessageHandler();
+
+protected:
+    void run() override;
+
+private:
+    bool openFile();
+    bool needsRotation(qint64 incomingBytes) const;
+    void rotate();
+    QString rotatedPath(int index, bool compressed) const;
+    static bool gzipFile(const QString &sourcePath, const QString &targetPath);
+    static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message);
+
+    LogRing m_queue;
+    QMutex m_wakeMutex;
+    QWaitCondition m_wake;
+    std::atomic<bool> m_stopRequested;
+    std::atomic<int> m_pending;
+    std::atomic<quint64> m_droppedTotal;
+
+    QString m_filePath;
+    qint64 m_maxBytes;
+    int m_maxAgeSeconds;
+    int m_keepFiles;
+    bool m_compressRotated;
+    int m_flushIntervalMs;
+
+    // 以下只在写线程中使用
+    QFile m_file;
+    QDateTime m_openedAt;
+
+    static std::atomic<LogFileSink *> s_handlerSink;
+    static QtMessageHandler s_previousHandler;
+};
+
+#endif // LOGFILESINK_H
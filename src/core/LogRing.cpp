@@ -0,0 +1,88 @@
+#include "LogRing.h"
+
+LogRing::LogRing(int capacity)
+    : m_head(0)
+    , m_tail(0)
+    , m_dropped(0)
+{
+    // 容量取2的幂，位置用掩码取槽位
+    quint64 size = 2;
+    while (size < quint64(qMax(2, capacity))) {
+        size <<= 1;
+    }
+
+    m_slots.reset(new Slot[size]);
+    m_mask = size - 1;
+    for (quint64 i = 0; i < size; ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool LogRing::push(const QString &message)
+{
+    if (tryPush(message)) {
+        return true;
+    }
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool LogRing::tryPush(const QString &message)
+{
+    quint64 pos = m_head.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot &slot = m_slots[pos & m_mask];
+        quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+        qint64 diff = qint64(sequence) - qint64(pos);
+
+        if (diff == 0) {
+            // 槽位空闲，抢占写位置
+            if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.message = message;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // 消费者还没取走上一轮的内容：队列已满
+            return false;
+        } else {
+            // 被其他生产者抢先，重新读取写位置
+            pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+int LogRing::drain(QStringList &out, int maxCount)
+{
+    int count = 0;
+    while (count < maxCount) {
+        Slot &slot = m_slots[m_tail & m_mask];
+        if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1) {
+            break;
+        }
+
+        out.append(std::move(slot.message));
+        slot.message = QString();
+        // 槽位留给下一轮的同一位置
+        slot.sequence.store(m_tail + m_mask + 1, std::memory_order_release);
+        m_tail++;
+        count++;
+    }
+    return count;
+}
+
+bool LogRing::isEmpty() const
+{
+    const Slot &slot = m_slots[m_tail & m_mask];
+    return slot.sequence.load(std::memory_order_acquire) != m_tail + 1;
+}
+
+quint64 LogRing::takeDropped()
+{
+    return m_dropped.exchange(0, std::memory_order_relaxed);
+}
+
+int LogRing::capacity() const
+{
+    return int(m_mask + 1);
+}
@@ -0,0 +1,88 @@
+#ifndef LOGRING_H
+#define LOGRING_H
+
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief 日志环形队列
+ * 多个生产者线程无锁写入，一个消费者线程（界面线程）按帧批量取出
+ *
+ * 每个槽位带序号：生产者用CAS抢占写位置，写完后发布序号；消费者按序号判断槽位是否可读
+ * 队列满时push()立即返回false并计入丢弃数，生产者永远不会阻塞
+ */
+class LogRing
+{
+public:
+    explicit LogRing(int capacity = 8192);
+
+    // 任意线程调用
+    bool push(const QString &message);
+
+    // 同push()，但队列满时不计入丢弃数，由调用方决定是否重试
+    bool tryPush(const QString &message);
+
+    // 仅消费者线程调用：最多取出maxCount条追加到out，返回取出的条数
+    int drain(QStringList &out, int maxCount);
+    bool isEmpty() const;
+
+    // 取出并清零丢弃计数
+    quint64 takeDropped();
+
+    int capacity() const;
+
+private:
+    struct Slot {
+        std::atomic<quint64> sequence;
+        QString message;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    quint64 m_mask;
+
+    alignas(64) std::atomic<quint64> m_head;    // 生产者写位置
+    alignas(64) quint64 m_tail;                 // 消费者读位置
+    std::atomic<quint64> m_dropped;
+};
+
+/**
+ * @brief 最新进度值
+ * 生产者只覆盖最新的(current, total)，消费者每帧取一次，中间值直接合并掉
+ */
+class LatestProgress
+{
+public:
+    LatestProgress() : m_value(0), m_dirty(false) {}
+
+    void store(int current, int total)
+    {
+        m_value.store((quint64(quint32(total)) << 32) | quint32(current), std::memory_order_relaxed);
+        m_dirty.store(true, std::memory_order_release);
+    }
+
+    // 自上次取出后有新值时返回true
+    bool take(int &current, int &total)
+    {
+        if (!m_dirty.exchange(false, std::memory_order_acq_rel)) {
+            return false;
+        }
+        quint64 value = m_value.load(std::memory_order_relaxed);
+        current = int(quint32(value));
+        total = int(quint32(value >> 32));
+        return true;
+    }
+
+    void clear()
+    {
+        m_dirty.store(false, std::memory_order_release);
+    }
+
+private:
+    std::atomic<quint64> m_value;
+    std::atomic<bool> m_dirty;
+};
+
+#endif // LOGRING_H
@@ -0,0 +1,285 @@
+#include "MediaInfoCache.h"
+#include <QFileInfo>
+#include <QProcess>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QMutexLocker>
+#include <QSet>
+
+namespace {
+
+const int ProbeTimeoutMs = 15000;
+
+// 远超任何缓存文件的时长（秒）：从这里向后定位，落在最后一个关键帧上
+const char *const SeekPastEnd = "99999999";
+
+// 不支持上面的定位方式时，退回按时长读取最后这么多秒
+const double TailSeconds = 10.0;
+
+// 末尾数据与容器时长允许的差距（秒），各路流的结束时间本来就略有出入
+const double TailTolerance = 2.0;
+
+const char *const FormatEntries = "format=format_name,duration,start_time:stream=index,codec_type,codec_name";
+const char *const PacketEntries = "packet=stream_index,pts_time,duration_time";
+
+/**
+ * 运行ffprobe。无法启动或超时时返回false，此时无法判断文件好坏
+ * 进程正常结束时返回true，stdout写入output，stderr（-v error下只有错误信息）写入error
+ */
+bool runFfprobe(const QString &program, const QStringList &arguments,
+                QByteArray *output, QString *error, int *exitCode)
+{
+    QProcess process;
+    process.start(program, arguments);
+    if (!process.waitForStarted()) {
+        *error = "ffprobe无法启动";
+        return false;
+    }
+    if (!process.waitForFinished(ProbeTimeoutMs)) {
+        process.kill();
+        process.waitForFinished(1000);
+        *error = "ffprobe超时";
+        return false;
+    }
+    if (process.exitStatus() != QProcess::NormalExit) {
+        *error = "ffprobe异常退出";
+        return false;
+    }
+
+    *output = process.readAllStandardOutput();
+    *error = QString::fromUtf8(process.readAllStandardError()).trimmed();
+    *exitCode = process.exitCode();
+    return true;
+}
+
+/**
+ * 返回streams中各路流最后一个数据包结束时间的最小值
+ * 某路流没有读到数据包时结束时间按0计
+ */
+double packetsEnd(const QJsonArray &packets, const QSet<int> &streams)
+{
+    QHash<int, double> ends;
+    for (const QJsonValue &value : packets) {
+        QJsonObject packet = value.toObject();
+        int index = packet.value("stream_index").toInt(-1);
+        bool ok = false;
+        double pts = packet.value("pts_time").toString().toDouble(&ok);
+        if (index < 0 || !ok || !streams.contains(index)) {
+            continue;
+        }
+        // duration_time为N/A时按0计
+        double end = pts + packet.value("duration_time").toString().toDouble();
+        auto it = ends.find(index);
+        if (it == ends.end()) {
+            ends.insert(index, end);
+        } else if (end > *it) {
+            *it = end;
+        }
+    }
+
+    double result = -1;
+    for (int index : streams) {
+        double end = ends.value(index, 0.0);
+        if (result < 0 || end < result) {
+            result = end;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+MediaInfoCache::MediaInfoCache(const QString &ffprobePath)
+    : m_ffprobePath(ffprobePath)
+    , m_probeCount(0)
+    , m_hitCount(0)
+{
+}
+
+void MediaInfoCache::setFfprobePath(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_ffprobePath != path) {
+        m_ffprobePath = path;
+        m_entries.clear();
+    }
+}
+
+QString MediaInfoCache::ffprobePath() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_ffprobePath;
+}
+
+bool MediaInfoCache::isAvailable() const
+{
+    QFileInfo fileInfo(ffprobePath());
+    return fileInfo.exists() && fileInfo.isExecutable();
+}
+
+MediaInfo MediaInfoCache::info(const QString &filePath)
+{
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists() || !fileInfo.isFile()) {
+        MediaInfo missing;
+        missing.error = "文件不存在";
+        return missing;
+    }
+
+    MediaInfo result;
+    if (lookup(fileInfo, &result) || !isAvailable()) {
+        return result;
+    }
+
+    // 在锁外探测，不同文件可并行；同一文件偶尔重复探测无害
+    QString key = fileInfo.absoluteFilePath();
+    result = probe(key);
+
+    QMutexLocker locker(&m_mutex);
+    m_probeCount++;
+    m_entries.insert(key, Entry{fileInfo.size(), fileInfo.lastModified(), result});
+    return result;
+}
+
+MediaInfo MediaInfoCache::cachedInfo(const QString &filePath)
+{
+    MediaInfo result;
+    lookup(QFileInfo(filePath), &result);
+    return result;
+}
+
+bool MediaInfoCache::lookup(const QFileInfo &fileInfo, MediaInfo *info)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.constFind(fileInfo.absoluteFilePath());
+    if (it == m_entries.constEnd() || it->size != fileInfo.size()
+        || it->modified != fileInfo.lastModified()) {
+        return false;
+    }
+    m_hitCount++;
+    *info = it->info;
+    return true;
+}
+
+void MediaInfoCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_probeCount = 0;
+    m_hitCount = 0;
+}
+
+int MediaInfoCache::probeCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_probeCount;
+}
+
+int MediaInfoCache::hitCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hitCount;
+}
+
+MediaInfo MediaInfoCache::probe(const QString &filePath) const
+{
+    MediaInfo info;
+    QString program = ffprobePath();
+
+    // 一次调用同时取得格式、流信息和文件末尾的数据包：容器时长来自文件头的索引，下载中断时仍是完整时长，
+    // 从远超时长的位置向后定位到最后一个关键帧读到文件末尾，就能看出数据是否真的到达时长
+    QByteArray output;
+    int exitCode = 0;
+    if (!runFfprobe(program, QStringList()
+                    << "-v" << "error"
+                    << "-read_intervals" << QString(SeekPastEnd) + "%"
+                    << "-show_entries" << QString(FormatEntries) + ":" + PacketEntries
+                    << "-of" << "json"
+                    << filePath, &output, &info.error, &exitCode)) {
+        // 没有得到结论，交给调用方按扩展名等方式判断
+        return info;
+    }
+
+    QJsonObject root = QJsonDocument::fromJson(output).object();
+    bool hasTail = exitCode == 0 && root.contains("format");
+    if (!hasTail) {
+        // 定位失败时ffprobe什么都不输出，可能只是格式不支持这种定位，只读文件头再判断
+        if (!runFfprobe(program, QStringList()
+                        << "-v" << "error"
+                        << "-show_entries" << FormatEntries
+                        << "-of" << "json"
+                        << filePath, &output, &info.error, &exitCode)) {
+            return info;
+        }
+        root = QJsonDocument::fromJson(output).object();
+    }
+    info.probed = true;
+
+    if (exitCode != 0 || !root.contains("format")) {
+        if (info.error.isEmpty()) {
+            info.error = QString("ffprobe退出码: %1").arg(exitCode);
+        }
+        return info;
+    }
+
+    QJsonObject format = root.value("format").toObject();
+    info.formatName = format.value("format_name").toString();
+    info.duration = format.value("duration").toString().toDouble();
+    double startTime = format.value("start_time").toString().toDouble();
+
+    QSet<int> mediaStreams;
+    const QJsonArray streams = root.value("streams").toArray();
+    for (const QJsonValue &value : streams) {
+        QJsonObject stream = value.toObject();
+        QString type = stream.value("codec_type").toString();
+        QString codec = stream.value("codec_name").toString();
+        if (type == "video") {
+            // 封面图片也是视频流，不计入
+            if (codec == "mjpeg" || codec == "png") {
+                continue;
+            }
+            if (info.videoStreams++ == 0) {
+                info.videoCodec = codec;
+            }
+        } else if (type == "audio") {
+            if (info.audioStreams++ == 0) {
+                info.audioCodec = codec;
+            }
+        } else {
+            continue;
+        }
+        mediaStreams.insert(stream.value("index").toInt());
+    }
+
+    info.valid = !mediaStreams.isEmpty();
+    if (!info.valid || info.duration <= 0) {
+        return info;
+    }
+
+    double tailEnd = -1;
+    if (hasTail) {
+        tailEnd = packetsEnd(root.value("packets").toArray(), mediaStreams);
+    } else {
+        // 退回按时长定位，读取最后TailSeconds秒
+        QString tailError;
+        double from = startTime + qMax(0.0, info.duration - TailSeconds);
+        if (runFfprobe(program, QStringList()
+                       << "-v" << "error"
+                       << "-read_intervals" << QString::number(from, 'f', 3) + "%"
+                       << "-show_entries" << PacketEntries
+                       << "-of" << "json"
+                       << filePath, &output, &tailError, &exitCode)) {
+            tailEnd = packetsEnd(QJsonDocument::fromJson(output).object().value("packets").toArray(), mediaStreams);
+        }
+    }
+
+    if (tailEnd >= 0 && tailEnd - startTime < info.duration - TailTolerance) {
+        info.truncated = true;
+        QString reason = QString("文件不完整：数据只到 %1 秒，时长应为 %2 秒")
+                             .arg(qMax(0.0, tailEnd - startTime), 0, 'f', 1)
+                             .arg(info.duration, 0, 'f', 1);
+        info.error = info.error.isEmpty() ? reason : reason + "\n" + info.error;
+    }
+    return info;
+}
@@ -0,0 +1,71 @@
+#ifndef MEDIAINFOCACHE_H
+#define MEDIAINFOCACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QDateTime>
+#include <QMutex>
+#include <QFileInfo>
+
+/**
+ * @brief 媒体文件信息
+ */
+struct MediaInfo {
+    bool probed = false;        // ffprobe是否给出了结论（无法启动或超时时为false，好坏未知）
+    bool valid = false;         // 容器可读且至少有一路音视频流
+    bool truncated = false;     // 可读但末尾的数据达不到容器时长（下载不完整）
+    QString formatName;         // 容器格式，如 "mov,mp4,m4a,3gp,3g2,mj2"
+    QString videoCodec;         // 第一路视频流编码，如 "h264"
+    QString audioCodec;         // 第一路音频流编码，如 "aac"
+    int videoStreams = 0;
+    int audioStreams = 0;
+    double duration = 0.0;      // 秒，未知时为0
+    QString error;              // ffprobe报告的错误
+};
+
+/**
+ * @brief ffprobe媒体信息缓存
+ * 每个文件只探测一次，按路径+大小+修改时间缓存，文件变化后自动重新探测
+ * 扫描校验、合并参数选择和进度计算共用同一份结果，可在多个线程中同时调用
+ */
+class MediaInfoCache
+{
+public:
+    explicit MediaInfoCache(const QString &ffprobePath = QString());
+
+    void setFfprobePath(const QString &path);
+    QString ffprobePath() const;
+
+    // ffprobe可执行时才能探测，否则info()只返回probed=false的结果
+    bool isAvailable() const;
+
+    // 获取媒体信息（命中缓存时不启动进程）
+    MediaInfo info(const QString &filePath);
+
+    // 只查缓存，未探测过时返回probed=false的结果，不会阻塞；供界面线程使用
+    MediaInfo cachedInfo(const QString &filePath);
+
+    void clear();
+
+    // 统计
+    int probeCount() const;
+    int hitCount() const;
+
+private:
+    struct Entry {
+        qint64 size;
+        QDateTime modified;
+        MediaInfo info;
+    };
+
+    bool lookup(const QFileInfo &fileInfo, MediaInfo *info);
+    MediaInfo probe(const QString &filePath) const;
+
+    mutable QMutex m_mutex;
+    QString m_ffprobePath;
+    QHash<QString, Entry> m_entries;
+    int m_probeCount;
+    int m_hitCount;
+};
+
+#endif // MEDIAINFOCACHE_H
@@ -0,0 +1,288 @@
+#include "MergeJournal.h"
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+
+#ifdef Q_OS_WINDOWS
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char *stateName(MergeJournal::State state)
+{
+    switch (state) {
+    case MergeJournal::Running: return "running";
+    case MergeJournal::Done:    return "done";
+    case MergeJournal::Failed:  return "failed";
+    default:                    return "pending";
+    }
+}
+
+MergeJournal::State stateFromName(const QString &name)
+{
+    if (name == "running") return MergeJournal::Running;
+    if (name == "done")    return MergeJournal::Done;
+    if (name == "failed")  return MergeJournal::Failed;
+    return MergeJournal::Pending;
+}
+
+} // namespace
+
+MergeJournal::MergeJournal()
+    : m_interrupted(0)
+{
+}
+
+MergeJournal::~MergeJournal()
+{
+    close();
+}
+
+bool MergeJournal::open(const QString &filePath)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_filePath = filePath;
+    m_records.clear();
+    m_interrupted = 0;
+
+    load();
+
+    // 重写为每个任务一行后再继续追加
+    if (!compact()) {
+        return false;
+    }
+
+    m_file.setFileName(m_filePath);
+    return m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+void MergeJournal::close()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_file.isOpen()) {
+        m_file.flush();
+        m_file.close();
+    }
+}
+
+bool MergeJournal::isOpen() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_file.isOpen();
+}
+
+void MergeJournal::remove()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    if (!m_filePath.isEmpty()) {
+        QFile::remove(m_filePath);
+    }
+    m_records.clear();
+}
+
+bool MergeJournal::hasRecord(const QString &key) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_records.contains(key);
+}
+
+MergeJournal::Record MergeJournal::record(const QString &key) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_records.value(key);
+}
+
+bool MergeJournal::isCompleted(const QString &key) const
+{
+    Record rec = record(key);
+    if (rec.state != Done || rec.outputPath.isEmpty()) {
+        return false;
+    }
+
+    QFileInfo info(rec.outputPath);
+    return info.exists() && info.size() == rec.size;
+}
+
+QStringList MergeJournal::outputPaths() const
+{
+    QMutexLocker locker(&m_mutex);
+    QStringList paths;
+    for (const Record &rec : m_records) {
+        if (!rec.outputPath.isEmpty()) {
+            paths.append(rec.outputPath);
+        }
+    }
+    return paths;
+}
+
+int MergeJournal::interruptedCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_interrupted;
+}
+
+void MergeJournal::markPending(const QStringList &keys)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_file.isOpen() || keys.isEmpty()) {
+        return;
+    }
+
+    // 大批量任务一次写入
+    QByteArray data;
+    for (const QString &key : keys) {
+        Record rec;
+        m_records.insert(key, rec);
+        data += encode(key, rec);
+    }
+    m_file.write(data);
+    m_file.flush();
+}
+
+void MergeJournal::markRunning(const QString &key, const QString &outputPath)
+{
+    Record rec;
+    rec.state = Running;
+    rec.outputPath = outputPath;
+
+    QMutexLocker locker(&m_mutex);
+    append(key, rec, false);
+}
+
+void MergeJournal::markDone(const QString &key, const QString &outputPath, qint64 size)
+{
+    Record rec;
+    rec.state = Done;
+    rec.outputPath = outputPath;
+    rec.size = size;
+
+    // 完成记录落盘后才算数，断电时最多重做这一个任务
+    QMutexLocker locker(&m_mutex);
+    append(key, rec, true);
+}
+
+void MergeJournal::markFailed(const QString &key, const QString &outputPath)
+{
+    Record rec;
+    rec.state = Failed;
+    rec.outputPath = outputPath;
+
+    QMutexLocker locker(&m_mutex);
+    append(key, rec, false);
+}
+
+QString MergeJournal::tempPathFor(const QString &outputPath)
+{
+    return outputPath + ".part";
+}
+
+void MergeJournal::load()
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        // 崩溃时未写完的行解析失败，直接跳过
+        QJsonDocument doc = QJsonDocument::fromJson(line);
+        if (!doc.isObject()) {
+            continue;
+        }
+
+        QJsonObject obj = doc.object();
+        QString key = obj.value("key").toString();
+        if (key.isEmpty()) {
+            continue;
+        }
+
+        Record rec;
+        rec.state = stateFromName(obj.value("state").toString());
+        rec.outputPath = obj.value("output").toString();
+        rec.size = static_cast<qint64>(obj.value("size").toDouble(-1));
+        m_records.insert(key, rec);
+    }
+
+    // 上次仍在合并的任务：清理残留临时文件，改为等待重做（沿用原输出路径）
+    for (auto it = m_records.begin(); it != m_records.end(); ++it) {
+        if (it->state == Running) {
+            m_interrupted++;
+            it->state = Pending;
+            if (!it->outputPath.isEmpty()) {
+                QFile::remove(tempPathFor(it->outputPath));
+            }
+        }
+    }
+}
+
+bool MergeJournal::compact()
+{
+    QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    for (auto it = m_records.constBegin(); it != m_records.constEnd(); ++it) {
+        file.write(encode(it.key(), it.value()));
+    }
+    return file.commit();
+}
+
+void MergeJournal::append(const QString &key, const Record &record, bool sync)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    m_records.insert(key, record);
+    m_file.write(encode(key, record));
+    m_file.flush();
+
+    if (sync) {
+        syncToDisk();
+    }
+}
+
+void MergeJournal::syncToDisk()
+{
+#ifdef Q_OS_WINDOWS
+    FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(m_file.handle())));
+#else
+    ::fsync(m_file.handle());
+#endif
+}
+
+QByteArray MergeJournal::encode(const QString &key, const Record &record)
+{
+    QJsonObject obj;
+    obj["state"] = stateName(record.state);
+    obj["key"] = key;
+    if (!record.outputPath.isEmpty()) {
+        obj["output"] = record.outputPath;
+    }
+    if (record.size >= 0) {
+        obj["size"] = static_cast<double>(record.size);
+    }
+    return QJsonDocument(obj).toJson(QJsonDocument::Compact) + '\n';
+}
@@ -0,0 +1,82 @@
+#ifndef MERGEJOURNAL_H
+#define MERGEJOURNAL_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QFile>
+#include <QMutex>
+
+/**
+ * @brief 合并日志
+ * 以追加方式记录每个合并任务的状态（等待/进行中/完成/失败）、输出路径和大小，
+ * 程序或机器中途退出后，下次运行可跳过已完成的任务，只重做被中断的任务
+ *
+ * 每行一条JSON记录，同一任务以最后一行为准；崩溃时写了一半的末行会被忽略
+ * 打开时会把历史记录压缩为每个任务一行，避免日志无限增长
+ * 可在多个线程中同时调用
+ */
+class MergeJournal
+{
+public:
+    enum State {
+        Pending,    // 等待合并（含上次中断的任务）
+        Running,    // 合并中
+        Done,       // 已完成
+        Failed      // 合并失败，下次重做
+    };
+
+    struct Record {
+        State state = Pending;
+        QString outputPath;
+        qint64 size = -1;
+    };
+
+    MergeJournal();
+    ~MergeJournal();
+
+    // 打开（不存在时创建）日志并读入上次的记录
+    bool open(const QString &filePath);
+    void close();
+    bool isOpen() const;
+
+    // 全部任务完成后删除日志
+    void remove();
+
+    // 上次运行留下的记录
+    bool hasRecord(const QString &key) const;
+    Record record(const QString &key) const;
+
+    // 已完成，且输出文件仍在、大小与记录一致
+    bool isCompleted(const QString &key) const;
+
+    // 日志中已分配的全部输出路径，生成新文件名时需避开
+    QStringList outputPaths() const;
+
+    // 上次运行中断时仍在合并的任务数
+    int interruptedCount() const;
+
+    void markPending(const QStringList &keys);
+    void markRunning(const QString &key, const QString &outputPath);
+    void markDone(const QString &key, const QString &outputPath, qint64 size);
+    void markFailed(const QString &key, const QString &outputPath);
+
+    // 合并时写入的临时文件，完成后原子改名为outputPath
+    static QString tempPathFor(const QString &outputPath);
+
+private:
+    void load();
+    bool compact();
+    void append(const QString &key, const Record &record, bool sync);
+    void syncToDisk();
+
+    static QByteArray encode(const QString &key, const Record &record);
+
+    mutable QMutex m_mutex;
+    QString m_filePath;
+    QFile m_file;
+    QHash<QString, Record> m_records;
+    int m_interrupted;
+};
+
+#endif // MERGEJOURNAL_H
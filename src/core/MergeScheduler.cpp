@@ -0,0 +1,166 @@
+#include "MergeScheduler.h"
+#include <QFileInfo>
+#include <QStorageInfo>
+#include <limits>
+
+MergeScheduler::MergeScheduler()
+    : m_maxJobs(1)
+    , m_streamsPerDevice(2)
+    , m_reserveBytes(0)
+    , m_running(0)
+    , m_budget(std::numeric_limits<qint64>::max() / 2)
+    , m_committedBytes(0)
+{
+}
+
+void MergeScheduler::setLimits(int maxJobs, int streamsPerDevice)
+{
+    m_maxJobs = qMax(1, maxJobs);
+    m_streamsPerDevice = qMax(1, streamsPerDevice);
+}
+
+void MergeScheduler::setOutputRoot(const QString &outputPath, qint64 reserveBytes)
+{
+    m_outputRoot = outputPath;
+    m_outputDevice = deviceOf(outputPath);
+    m_reserveBytes = qMax<qint64>(0, reserveBytes);
+    m_deviceCache.clear();
+}
+
+qint64 MergeScheduler::inputSize(const FileScanner::VideoFile &videoFile)
+{
+    qint64 size = 0;
+    if (videoFile.isBlvFormat) {
+        for (const QString &blvFile : videoFile.blvFiles) {
+            size += QFileInfo(blvFile).size();
+        }
+    } else {
+        size += QFileInfo(videoFile.videoPath).size();
+        size += QFileInfo(videoFile.audioPath).size();
+    }
+    return size;
+}
+
+qint64 MergeScheduler::estimateOutputSize(const FileScanner::VideoFile &videoFile)
+{
+    qint64 size = inputSize(videoFile);
+
+    // 预留约1%的容器开销
+    return size + size / 100;
+}
+
+QString MergeScheduler::deviceOf(const QString &path)
+{
+    QStorageInfo storage(path);
+    if (!storage.isValid()) {
+        return QString();
+    }
+    return QString::fromLocal8Bit(storage.device());
+}
+
+QString MergeScheduler::deviceOfFile(const QString &filePath)
+{
+    QString dir = QFileInfo(filePath).absolutePath();
+    auto it = m_deviceCache.constFind(dir);
+    if (it != m_deviceCache.constEnd()) {
+        return *it;
+    }
+    QString device = deviceOf(dir);
+    m_deviceCache.insert(dir, device);
+    return device;
+}
+
+QList<MergeScheduler::Job> MergeScheduler::plan(QList<Job> &jobs)
+{
+    QList<Job> refused;
+
+    // 运行开始前还没有任何输出，此时的可用空间就是整次运行的预算
+    m_budget = availableBytes() - m_reserveBytes;
+    m_committedBytes = 0;
+    qint64 budget = m_budget;
+    if (totalBytes(jobs) <= budget) {
+        return refused;
+    }
+
+    // 空间不足：按原顺序依次装入，放不下的大任务让位给后面的小任务
+    QList<Job> accepted;
+    for (const Job &job : jobs) {
+        if (job.expectedBytes <= budget) {
+            budget -= job.expectedBytes;
+            accepted.append(job);
+        } else {
+            refused.append(job);
+        }
+    }
+
+    jobs = accepted;
+    return refused;
+}
+
+MergeScheduler::Admission MergeScheduler::tryAdmit(const Job &job)
+{
+    if (m_committedBytes + job.expectedBytes > m_budget) {
+        // 运行中的任务结束后按实际大小结算，可能腾出预算；没有运行中的任务时再等也没用
+        return m_running > 0 ? WaitForSlot : NoSpace;
+    }
+
+    if (m_running >= m_maxJobs) {
+        return WaitForSlot;
+    }
+
+    bool crossDevice = isCrossDevice(job);
+    if (crossDevice
+        && (m_deviceStreams.value(job.inputDevice) >= m_streamsPerDevice
+            || m_deviceStreams.value(m_outputDevice) >= m_streamsPerDevice)) {
+        return WaitForSlot;
+    }
+
+    m_running++;
+    m_committedBytes += job.expectedBytes;
+    if (crossDevice) {
+        m_deviceStreams[job.inputDevice]++;
+        m_deviceStreams[m_outputDevice]++;
+    }
+
+    return Admitted;
+}
+
+void MergeScheduler::release(const Job &job, qint64 writtenBytes)
+{
+    m_running--;
+    m_committedBytes += writtenBytes - job.expectedBytes;
+    if (isCrossDevice(job)) {
+        m_deviceStreams[job.inputDevice]--;
+        m_deviceStreams[m_outputDevice]--;
+    }
+}
+
+int MergeScheduler::runningCount() const
+{
+    return m_running;
+}
+
+qint64 MergeScheduler::availableBytes() const
+{
+    QStorageInfo storage(m_outputRoot);
+    if (!storage.isValid() || storage.bytesAvailable() < 0) {
+        // 无法获取卷信息时不做空间限制
+        return std::numeric_limits<qint64>::max() / 2;
+    }
+    return storage.bytesAvailable();
+}
+
+qint64 MergeScheduler::totalBytes(const QList<Job> &jobs) const
+{
+    qint64 total = 0;
+    for (const Job &job : jobs) {
+        total += job.expectedBytes;
+    }
+    return total;
+}
+
+bool MergeScheduler::isCrossDevice(const Job &job) const
+{
+    // 设备未知时按同盘处理，只受总任务数限制
+    return !job.inputDevice.isEmpty() && !m_outputDevice.isEmpty() && job.inputDevice != m_outputDevice;
+}
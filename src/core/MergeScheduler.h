@@ -0,0 +1,85 @@
+#ifndef MERGESCHEDULER_H
+#define MERGESCHEDULER_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include "FileScanner.h"
+
+/**
+ * @brief 合并任务调度器
+ * 根据目标卷剩余空间和磁盘设备占用决定合并任务能否开始
+ *
+ * - 开始前按扫描到的音视频文件大小估算输出总量，放不下的任务直接拒绝，
+ *   其余任务保持原顺序，小任务不会被前面的大任务卡住
+ * - 开始前记下目标卷的可用空间作为预算，运行时按预算准入：运行中的任务按预计大小计，
+ *   结束的任务按实际写出的大小计，不会把已写出的部分和预计大小重复扣除
+ * - 输入和输出在不同磁盘上时，每个任务在输入盘上占一个读流、在输出盘上占一个写流，
+ *   每块盘的并发流数受限，读写两块盘同时保持忙碌；同盘任务只受总任务数限制
+ *
+ * 本类不加锁，由调用方（MergeThread）在自己的互斥锁内调用
+ */
+class MergeScheduler
+{
+public:
+    struct Job {
+        int groupIndex;
+        int fileIndex;
+        qint64 expectedBytes;   // 预计输出大小
+        QString inputDevice;    // 输入文件所在设备
+    };
+
+    enum Admission {
+        Admitted,       // 可以开始，已占用空间和设备槽位
+        WaitForSlot,    // 设备或并发数已满，等待其他任务结束
+        NoSpace         // 没有运行中的任务时预算仍不够，无法开始
+    };
+
+    MergeScheduler();
+
+    // 并发限制：总任务数、跨盘任务在每块盘上的并发流数
+    void setLimits(int maxJobs, int streamsPerDevice);
+
+    // 输出位置和需保留的剩余空间，每次运行开始时调用
+    void setOutputRoot(const QString &outputPath, qint64 reserveBytes);
+
+    // 单个视频的输入文件总大小
+    static qint64 inputSize(const FileScanner::VideoFile &videoFile);
+
+    // 估算单个视频的输出大小（封装复制，约等于输入之和）
+    static qint64 estimateOutputSize(const FileScanner::VideoFile &videoFile);
+
+    // 文件或目录所在的设备标识
+    static QString deviceOf(const QString &path);
+
+    // 文件所在的设备标识，按所在目录缓存（同一目录下的文件只查询一次）
+    QString deviceOfFile(const QString &filePath);
+
+    // 开始前规划：取当前可用空间作为本次运行的预算，拒绝放不下的任务，返回被拒绝的任务
+    QList<Job> plan(QList<Job> &jobs);
+
+    // 运行时准入与释放；writtenBytes为任务实际留下的输出大小（失败时为0）
+    Admission tryAdmit(const Job &job);
+    void release(const Job &job, qint64 writtenBytes);
+
+    int runningCount() const;
+    qint64 availableBytes() const;
+    qint64 totalBytes(const QList<Job> &jobs) const;
+
+private:
+    bool isCrossDevice(const Job &job) const;
+
+    int m_maxJobs;
+    int m_streamsPerDevice;
+    QString m_outputRoot;
+    QString m_outputDevice;
+    qint64 m_reserveBytes;
+
+    int m_running;
+    qint64 m_budget;                    // plan()时的可用空间减去保留空间
+    qint64 m_committedBytes;            // 已占用的预算：运行中按预计大小，已结束按实际大小
+    QHash<QString, int> m_deviceStreams;
+    QHash<QString, QString> m_deviceCache;  // 目录 -> 设备标识
+};
+
+#endif // MERGESCHEDULER_H
@@ -4,6 +4,11 @@
 #include "FfmpegManager.h"
 #include "DanmakuConverter.h"
 #include "SubtitleDownloader.h"
+#include "PostProcessor.h"
+#include "CoverCache.h"
+#include "MergeJournal.h"
+#include "MediaInfoCache.h"
+#include "Utils.h"
 
 #include <QFile>
 #include <QDir>
@@ -11,28 +16,51 @@
 #include <QStandardPaths>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QRegularExpression>
+#include <QEventLoop>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <QThreadPool>
 #include <QDebug>
 #include <QCoreApplication>
+#include <QDateTime>
+#include <QDeadlineTimer>
 
 MergeThread::MergeThread(QObject *parent)
     : QThread(parent)
     , m_configManager(nullptr)
     , m_ffmpegManager(nullptr)
+    , m_patternManager(nullptr)
     , m_danmakuConverter(nullptr)
-    , m_subtitleDownloader(nullptr)
+    , m_postProcessor(new PostProcessor(this))
+    , m_coverCache(new CoverCache(this))
+    , m_mergePool(new QThreadPool(this))
+    , m_journal(new MergeJournal())
     , m_currentIndex(0)
     , m_totalCount(0)
     , m_successCount(0)
     , m_failedCount(0)
     , m_paused(false)
     , m_stopped(false)
+    , m_abortRequested(false)
+    , m_cancelRequested(false)
 {
+    defineMetrics();
+
+    // 附属任务失败只记录日志，不影响合并结果
+    connect(m_postProcessor, &PostProcessor::taskFinished, this,
+            [this](const QString &name, bool success, const QString &error) {
+                if (!success) {
+                    emit logMessage(QString("⚠ %1 失败: %2").arg(name, error));
+                }
+            }, Qt::DirectConnection);
 }
 
 MergeThread::~MergeThread()
 {
     stop();
     wait();
+    delete m_journal;
 }
 
 void MergeThread::setConfig(const MergeConfig &config)
@@ -51,14 +79,14 @@ void MergeThread::setFfmpegManager(FfmpegManager *manager)
     m_ffmpegManager = manager;
 }
 
-void MergeThread::setDanmakuConverter(DanmakuConverter *converter)
+void MergeThread::setPatternManager(PatternManager *manager)
 {
-    m_danmakuConverter = converter;
+    m_patternManager = manager;
 }
 
-void MergeThread::setSubtitleDownloader(SubtitleDownloader *downloader)
+void MergeThread::setDanmakuConverter(DanmakuConverter *converter)
 {
-    m_subtitleDownloader = downloader;
+    m_danmakuConverter = converter;
 }
 
 void MergeThread::pause()
@@ -78,6 +106,9 @@ void MergeThread::resume()
 
 void MergeThread::stop()
 {
+    // 合并线程不持锁检查此标志，正在运行的FFmpeg会在100ms内被终止
+    m_cancelRequested = true;
+
     QMutexLocker locker(&m_mutex);
     m_stopped = true;
     m_waitCondition.wakeAll();
@@ -88,28 +119,74 @@ void MergeThread::run()
     m_currentIndex = 0;
     m_successCount = 0;
     m_failedCount = 0;
+    m_abortRequested = false;
+    m_cancelRequested = false;
+    m_nameTables.clear();
+    m_postProcessor->resetCounters();
+    m_postProcessor->setMaxWorkers(m_config.postWorkers);
+    m_trace.reset();
+    // 只有导出trace文件时才需要逐条事件，否则只累计各阶段汇总
+    m_trace.setKeepEvents(!m_config.tracePath.isEmpty());
+    m_metrics.reset();
+    m_metricsTimer.invalidate();
+    m_metrics.set("bilicache_run_active", 1);
+    m_metrics.set("bilicache_run_start_timestamp_seconds", QDateTime::currentSecsSinceEpoch());
 
     emit statusChanged("初始化...");
 
+    if (!m_patternManager) {
+        emit errorOccurred("模式管理器未设置");
+        return;
+    }
+
     // 扫描视频文件
-    FileScanner scanner(m_configManager, nullptr);
+    FileScanner scanner(m_configManager, m_patternManager);
+    scanner.setTraceRecorder(&m_trace);
+    int probesBefore = 0;
+    if (m_ffmpegManager && m_config.probeMedia) {
+        scanner.setMediaInfoCache(m_ffmpegManager->mediaInfo());
+        probesBefore = m_ffmpegManager->mediaInfo()->probeCount();
+    }
     FileScanner::ScanConfig scanConfig;
     scanConfig.searchPath = m_config.inputPath;
     scanConfig.patternName = m_config.patternName;
     scanConfig.oneDir = m_config.oneDir;
+    scanConfig.overwrite = m_config.overwrite;
+    scanConfig.ordered = m_config.ordered;
     scanConfig.danmuEnabled = m_config.danmuEnabled;
     scanConfig.coverEnabled = m_config.coverEnabled;
     scanConfig.subtitleEnabled = m_config.subtitleEnabled;
-
-    if (!scanner.scan(scanConfig)) {
+    scanConfig.writeRepairedJson = m_config.writeRepairedJson;
+
+    bool scanned;
+    {
+        TraceSpan span(&m_trace, "scan", m_config.inputPath);
+        QElapsedTimer scanTimer;
+        scanTimer.start();
+        scanned = scanner.scan(scanConfig);
+        m_metrics.set("bilicache_scan_duration_seconds", scanTimer.nsecsElapsed() / 1e9);
+    }
+    if (!scanned) {
+        m_metrics.set("bilicache_run_active", 0);
+        updateMetricsFile(true);
         emit errorOccurred("扫描视频文件失败");
         return;
     }
 
-    m_videoGroups = scanner.videoGroups();
+    m_videoGroups = scanner.takeVideoGroups();
     m_totalCount = scanner.totalFiles();
+    if (m_ffmpegManager && m_config.probeMedia) {
+        int probes = m_ffmpegManager->mediaInfo()->probeCount() - probesBefore;
+        if (probes > 0) {
+            emit logMessage(QString("已用ffprobe检查 %1 个媒体文件").arg(probes));
+        }
+    }
+    m_metrics.increment("bilicache_files_scanned_total", m_totalCount);
+    m_metrics.set("bilicache_files", m_totalCount);
 
     if (m_totalCount == 0) {
+        m_metrics.set("bilicache_run_active", 0);
+        updateMetricsFile(true);
         emit logMessage("未找到可合并的视频文件");
         emit mergeCompleted(0, 0);
         return;
@@ -123,56 +200,259 @@ void MergeThread::run()
         outputDir.mkpath(".");
     }
 
-    // 处理每个视频组
-    for (const FileScanner::VideoGroup &group : m_videoGroups) {
-        if (m_stopped) {
-            break;
-        }
+    // 封面缓存放在输出目录下，分发时可直接硬链接
+    m_coverCache->setCacheDir(outputDir.filePath(".covers"));
+
+    m_scheduler.setLimits(m_config.concurrency, m_config.streamsPerDevice);
+    m_scheduler.setOutputRoot(m_config.outputPath, m_config.reserveBytes);
+
+    // 为每组创建目录（如果不是单目录模式），并生成合并任务
+    QStringList groupOutputDirs;
+    QList<MergeScheduler::Job> jobs;
+    for (int g = 0; g < m_videoGroups.size(); ++g) {
+        const FileScanner::VideoGroup &group = m_videoGroups[g];
 
-        // 为每组创建目录（如果不是单目录模式）
         QString groupOutputDir = m_config.outputPath;
         if (!m_config.oneDir) {
-            QString groupName = group.groupMetadata.value("title").toString();
+            QString groupName = group.title;
             if (!groupName.isEmpty()) {
                 groupName = cleanFileName(groupName);
                 groupOutputDir = QDir(m_config.outputPath).filePath(groupName);
                 QDir(groupOutputDir).mkpath(".");
             }
         }
+        groupOutputDirs.append(groupOutputDir);
+
+        for (int f = 0; f < group.files.size(); ++f) {
+            const FileScanner::VideoFile &videoFile = group.files[f];
+            MergeScheduler::Job job;
+            job.groupIndex = g;
+            job.fileIndex = f;
+            job.expectedBytes = MergeScheduler::estimateOutputSize(videoFile);
+            job.inputDevice = m_scheduler.deviceOfFile(videoFile.isBlvFormat ? videoFile.blvPath
+                                                                             : videoFile.videoPath);
+            jobs.append(job);
+        }
+    }
 
-        // 处理组中的每个视频文件
-        for (const FileScanner::VideoFile &videoFile : group.files) {
-            if (m_stopped) {
-                break;
-            }
+    // 读入上次的合并日志，跳过已完成的任务
+    if (!m_journal->open(outputDir.filePath(".bilimerge_journal.jsonl"))) {
+        emit logMessage("无法打开合并日志，本次中断后需从头开始");
+    }
 
-            waitIfPaused();
+    // 日志中已分配的文件名按目录归类，各目录的占用表首次使用时直接取用
+    m_journalNames.clear();
+    for (const QString &path : m_journal->outputPaths()) {
+        QFileInfo info(path);
+        m_journalNames[QDir::cleanPath(info.absolutePath())].append(info.fileName());
+    }
 
-            QString outputPath = generateOutputPath(videoFile, groupOutputDir);
-            emit statusChanged(QString("合并中: %1").arg(QFileInfo(outputPath).baseName()));
+    int resumedCount = 0;
+    QList<MergeScheduler::Job> remaining;
+    QStringList newKeys;
+    for (const MergeScheduler::Job &job : jobs) {
+        QString key = jobKey(m_videoGroups[job.groupIndex].files[job.fileIndex]);
+        if (m_journal->isCompleted(key)) {
+            resumedCount++;
+            continue;
+        }
+        if (!m_journal->hasRecord(key)) {
+            newKeys.append(key);
+        }
+        remaining.append(job);
+    }
+    jobs = remaining;
+    m_journal->markPending(newKeys);
+
+    if (resumedCount > 0) {
+        m_currentIndex = resumedCount;
+        m_successCount = resumedCount;
+        m_metrics.increment("bilicache_merges_total", resumedCount, "result=\"resumed\"");
+        m_metrics.set("bilicache_files_processed", resumedCount);
+        emit progressUpdated(m_currentIndex, m_totalCount);
+        emit logMessage(QString("上次已完成 %1 个文件，跳过").arg(resumedCount));
+    }
+    if (m_journal->interruptedCount() > 0) {
+        emit logMessage(QString("上次中断 %1 个文件，将重新合并").arg(m_journal->interruptedCount()));
+    }
 
-            bool success = mergeSingleVideo(videoFile, outputPath);
+    // 按目标卷剩余空间规划，放不下的任务直接拒绝
+    emit logMessage(QString("预计输出 %1，目标卷可用 %2")
+                    .arg(Utils::formatFileSize(m_scheduler.totalBytes(jobs)))
+                    .arg(Utils::formatFileSize(m_scheduler.availableBytes())));
+
+    QList<MergeScheduler::Job> refused = m_scheduler.plan(jobs);
+    if (!refused.isEmpty()) {
+        emit logMessage(QString("目标卷空间不足，跳过 %1 个文件（共 %2）")
+                        .arg(refused.size())
+                        .arg(Utils::formatFileSize(m_scheduler.totalBytes(refused))));
+        for (const MergeScheduler::Job &job : refused) {
+            finishJob(job, QString(), false, "磁盘空间不足");
+        }
+    }
 
-            m_currentIndex++;
-            emit progressUpdated(m_currentIndex, m_totalCount);
+    // 逐个派发任务，设备槽位和并发数由调度器控制
+    m_abortRequested = m_abortRequested || (!refused.isEmpty() && !m_config.errorSkip);
+    m_mergePool->setMaxThreadCount(qMax(1, m_config.concurrency));
 
-            if (success) {
-                m_successCount++;
-                emit fileMerged(outputPath);
-                emit logMessage(QString("✓ %1").arg(QFileInfo(outputPath).fileName()));
-            } else {
-                m_failedCount++;
-                QString errorMsg = QString("✗ %1").arg(QFileInfo(videoFile.entryPath).fileName());
-                emit errorOccurred(errorMsg);
-                emit logMessage(errorMsg);
-
-                // 如果不跳过错误，则停止
-                if (!m_config.errorSkip) {
-                    emit logMessage("合并已停止（错误跳过未启用）");
-                    break;
+    // 连续的小文件打包成批，一批占用一个合并槽位
+    QList<QList<MergeScheduler::Job>> batches = buildBatches(jobs);
+
+    for (const QList<MergeScheduler::Job> &batch : batches) {
+        waitIfPaused();
+        if (m_stopped || m_abortRequested) {
+            break;
+        }
+
+        // 批量任务按总大小向调度器申请
+        MergeScheduler::Job slot = batch.first();
+        for (int i = 1; i < batch.size(); ++i) {
+            slot.expectedBytes += batch[i].expectedBytes;
+        }
+
+        MergeScheduler::Admission admission;
+        {
+            TraceSpan span(&m_trace, "dispatch.wait_slot");
+            QMutexLocker locker(&m_mutex);
+            while ((admission = m_scheduler.tryAdmit(slot)) == MergeScheduler::WaitForSlot
+                   && !m_stopped) {
+                // 长时间合并期间也要定期刷新指标文件
+                if (!m_waitCondition.wait(&m_mutex, QDeadlineTimer(metricsWaitMs()))) {
+                    locker.unlock();
+                    updateMetricsFile(false);
+                    locker.relock();
                 }
             }
         }
+        if (m_stopped) {
+            break;
+        }
+
+        if (admission == MergeScheduler::NoSpace) {
+            for (const MergeScheduler::Job &job : batch) {
+                finishJob(job, QString(), false, "磁盘空间不足");
+            }
+            continue;
+        }
+
+        QList<DispatchItem> items;
+        for (const MergeScheduler::Job &job : batch) {
+            const FileScanner::VideoFile &videoFile = m_videoGroups[job.groupIndex].files[job.fileIndex];
+            DispatchItem item;
+            item.job = job;
+            item.key = jobKey(videoFile);
+
+            // 续传时沿用上次分配的文件名，避免生成name(1)之类的重复文件
+            item.outputPath = m_journal->record(item.key).outputPath;
+            if (item.outputPath.isEmpty()
+                || QFileInfo(item.outputPath).absolutePath() != QFileInfo(groupOutputDirs[job.groupIndex]).absoluteFilePath()) {
+                item.outputPath = generateOutputPath(videoFile, groupOutputDirs[job.groupIndex]);
+            }
+            m_journal->markRunning(item.key, item.outputPath);
+            items.append(item);
+        }
+        if (items.size() == 1) {
+            emit statusChanged(QString("合并中: %1").arg(QFileInfo(items.first().outputPath).baseName()));
+        } else {
+            emit statusChanged(QString("批量合并中: %1 等 %2 个文件")
+                               .arg(QFileInfo(items.first().outputPath).baseName())
+                               .arg(items.size()));
+        }
+
+        m_mergePool->start([this, slot, items]() {
+            QList<bool> results;
+            if (items.size() == 1) {
+                const DispatchItem &item = items.first();
+                const FileScanner::VideoGroup &group = m_videoGroups[item.job.groupIndex];
+                TraceSpan span(&m_trace, "merge.job", item.outputPath);
+                results.append(mergeSingleVideo(group.files[item.job.fileIndex], item.outputPath, group.coverPath));
+            } else {
+                TraceSpan span(&m_trace, "merge.batch", items.first().outputPath);
+                results = mergeBatch(items);
+            }
+
+            // 因stop()被终止的任务不算失败：日志中保持running状态，下次运行时作为中断任务重新合并
+            QList<bool> cancelled(items.size(), false);
+            for (int i = 0; i < items.size(); ++i) {
+                cancelled[i] = !results[i] && m_cancelRequested;
+            }
+
+            qint64 writtenBytes = 0;
+            for (int i = 0; i < items.size(); ++i) {
+                const DispatchItem &item = items[i];
+                const FileScanner::VideoFile &videoFile = m_videoGroups[item.job.groupIndex].files[item.job.fileIndex];
+                if (cancelled[i]) {
+                    continue;
+                }
+                qint64 outputSize = results[i] ? QFileInfo(item.outputPath).size() : 0;
+                writtenBytes += outputSize;
+                if (results[i]) {
+                    m_metrics.increment("bilicache_bytes_read_total", MergeScheduler::inputSize(videoFile));
+                    m_metrics.increment("bilicache_bytes_written_total", outputSize);
+                }
+
+                TraceSpan journalSpan(&m_trace, "merge.journal", item.outputPath);
+                if (results[i]) {
+                    m_journal->markDone(item.key, item.outputPath, outputSize);
+                } else {
+                    m_journal->markFailed(item.key, item.outputPath);
+                }
+            }
+
+            {
+                QMutexLocker locker(&m_mutex);
+                m_scheduler.release(slot, writtenBytes);
+                m_waitCondition.wakeAll();
+            }
+            for (int i = 0; i < items.size(); ++i) {
+                if (cancelled[i]) {
+                    emit logMessage(QString("已中止: %1").arg(QFileInfo(items[i].outputPath).fileName()));
+                } else {
+                    finishJob(items[i].job, items[i].outputPath, results[i], QString());
+                }
+            }
+        });
+    }
+
+    // 等待已派发的合并完成
+    while (!m_mergePool->waitForDone(metricsWaitMs())) {
+        updateMetricsFile(false);
+    }
+
+    if (m_abortRequested && !m_config.errorSkip) {
+        emit logMessage("合并已停止（错误跳过未启用）");
+    }
+
+    // 等待附属任务收尾（停止时丢弃尚未开始的任务）
+    if (m_stopped) {
+        m_postProcessor->cancelPending();
+    }
+    if (m_postProcessor->pendingCount() > 0) {
+        emit statusChanged("等待附属任务完成...");
+    }
+    while (!m_postProcessor->waitForDone(metricsWaitMs())) {
+        updateMetricsFile(false);
+    }
+    if (m_postProcessor->failedCount() > 0) {
+        emit logMessage(QString("附属任务完成 %1 个，失败 %2 个")
+                        .arg(m_postProcessor->succeededCount())
+                        .arg(m_postProcessor->failedCount()));
+    }
+    if (m_coverCache->requestCount() > 0) {
+        emit logMessage(QString("封面下载请求 %1 次").arg(m_coverCache->requestCount()));
+    }
+    m_coverCache->clear();
+
+    reportTrace();
+
+    m_metrics.set("bilicache_run_active", 0);
+    updateMetricsFile(true);
+
+    // 全部完成后不再需要续传
+    if (!m_stopped && m_failedCount == 0) {
+        m_journal->remove();
+    } else {
+        m_journal->close();
     }
 
     emit mergeCompleted(m_successCount, m_failedCount);
@@ -185,7 +465,47 @@ void MergeThread::run()
     }
 }
 
-bool MergeThread::mergeSingleVideo(const FileScanner::VideoFile &videoFile, const QString &outputPath)
+void MergeThread::finishJob(const MergeScheduler::Job &job, const QString &outputPath,
+                            bool success, const QString &reason)
+{
+    const FileScanner::VideoFile &videoFile = m_videoGroups[job.groupIndex].files[job.fileIndex];
+
+    m_metrics.increment("bilicache_merges_total", 1, success ? "result=\"ok\"" : "result=\"failed\"");
+
+    int current;
+    {
+        QMutexLocker locker(&m_mutex);
+        current = ++m_currentIndex;
+        m_metrics.set("bilicache_files_processed", current);
+        if (success) {
+            m_successCount++;
+        } else {
+            m_failedCount++;
+            // 如果不跳过错误，则不再派发新任务
+            if (!m_config.errorSkip) {
+                m_abortRequested = true;
+            }
+        }
+    }
+
+    emit progressUpdated(current, m_totalCount);
+    updateMetricsFile(false);
+
+    if (success) {
+        emit fileMerged(outputPath);
+        emit logMessage(QString("✓ %1").arg(QFileInfo(outputPath).fileName()));
+    } else {
+        QString errorMsg = QString("✗ %1").arg(QFileInfo(videoFile.entryPath).fileName());
+        if (!reason.isEmpty()) {
+            errorMsg += QString(" (%1)").arg(reason);
+        }
+        emit errorOccurred(errorMsg);
+        emit logMessage(errorMsg);
+    }
+}
+
+bool MergeThread::mergeSingleVideo(const FileScanner::VideoFile &videoFile, const QString &outputPath,
+                                   const QString &groupCoverPath)
 {
     // 创建输出目录
     QDir outputDir = QFileInfo(outputPath).dir();
@@ -193,42 +513,115 @@ bool MergeThread::mergeSingleVideo(const FileScanner::VideoFile &videoFile, cons
         outputDir.mkpath(".");
     }
 
+    // 封面、弹幕、字幕交给后处理阶段，与合并并行执行
+    schedulePostTasks(videoFile, outputPath, groupCoverPath);
+
+    return mergeToOutput(videoFile, outputPath);
+}
+
+bool MergeThread::mergeToOutput(const FileScanner::VideoFile &videoFile, const QString &outputPath)
+{
+    // 先写入临时文件，完成后原子改名，中断时不会留下半个视频
+    QString tempPath = MergeJournal::tempPathFor(outputPath);
+    bool success;
+    {
+        TraceSpan span(&m_trace, "merge.ffmpeg", outputPath);
+        QElapsedTimer ffmpegTimer;
+        ffmpegTimer.start();
+        if (videoFile.isBlvFormat) {
+            success = mergeBLVFiles(videoFile, tempPath);
+        } else {
+            success = mergeVideoAudio(videoFile, tempPath);
+        }
+        m_metrics.observe("bilicache_ffmpeg_duration_seconds", ffmpegTimer.nsecsElapsed() / 1e9);
+    }
+
+    if (!success) {
+        QFile::remove(tempPath);
+        return false;
+    }
+
+    if (!Utils::replaceFile(tempPath, outputPath)) {
+        QFile::remove(tempPath);
+        emit errorOccurred(QString("无法写入输出文件: %1").arg(outputPath));
+        return false;
+    }
+    return true;
+}
+
+QString MergeThread::jobKey(const FileScanner::VideoFile &videoFile)
+{
+    // 以缓存条目所在位置标识任务，与输出文件名无关
+    QString source = videoFile.entryPath;
+    if (source.isEmpty()) {
+        source = videoFile.isBlvFormat ? videoFile.blvPath : videoFile.videoPath;
+    }
+    return QFileInfo(source).absoluteFilePath();
+}
+
+void MergeThread::schedulePostTasks(const FileScanner::VideoFile &videoFile, const QString &outputPath,
+                                    const QString &groupCoverPath)
+{
+    // 附属文件与输出视频同目录、同名
+    QFileInfo outputInfo(outputPath);
+    QString outputDir = outputInfo.absolutePath();
+    QString baseName = outputInfo.completeBaseName();
+
     // 处理封面
     if (m_config.coverEnabled) {
-        QString coverPath = QDir(outputPath).filePath("cover.jpg");
-        if (QFile::exists(videoFile.coverPath)) {
-            QFile::copy(videoFile.coverPath, coverPath);
-        } else {
-            // 下载封面
-            QString coverUrl = videoFile.metadata.value("cover_url").toString();
-            if (!coverUrl.isEmpty()) {
-                downloadCover(coverUrl, coverPath);
-            }
+        QString localCover = videoFile.coverPath.isEmpty() ? groupCoverPath : videoFile.coverPath;
+        QString coverUrl = videoFile.metadata.coverUrl;
+        QString coverPath = QDir(outputDir).filePath(baseName + ".jpg");
+
+        if (QFile::exists(localCover) || !coverUrl.isEmpty()) {
+            m_postProcessor->submit(QString("封面 %1").arg(baseName),
+                [this, localCover, coverUrl, coverPath](QString &error) {
+                    TraceSpan span(&m_trace, "post.cover", coverPath);
+                    if (QFile::exists(localCover)) {
+                        if (!Utils::linkOrCopyFile(localCover, coverPath)) {
+                            error = QString("无法复制封面: %1").arg(localCover);
+                            return false;
+                        }
+                        return true;
+                    }
+                    return downloadCover(coverUrl, coverPath, error);
+                });
         }
     }
 
     // 处理弹幕转ASS
-    if (m_config.danmuEnabled) {
-        QString danmuPath = QDir(outputPath).filePath("danmu.ass");
-        convertDanmaku(videoFile.danmuPath, danmuPath);
+    if (m_config.danmuEnabled && QFile::exists(videoFile.danmuPath)) {
+        QString danmuPath = videoFile.danmuPath;
+        QString assPath = QDir(outputDir).filePath(baseName + ".ass");
+
+        m_postProcessor->submit(QString("弹幕 %1").arg(baseName),
+            [this, danmuPath, assPath](QString &error) {
+                TraceSpan span(&m_trace, "post.danmaku", danmuPath);
+                if (!convertDanmaku(danmuPath, assPath)) {
+                    error = QString("转换失败: %1").arg(danmuPath);
+                    return false;
+                }
+                return true;
+            });
     }
 
     // 处理字幕下载
     if (m_config.subtitleEnabled) {
-        QString subtitleDir = QDir(outputPath).filePath("subtitles");
-        QString aid = videoFile.metadata.value("aid").toString();
-        QString cid = videoFile.metadata.value("cid").toString();
+        QString aid = videoFile.metadata.aidText();
+        QString cid = videoFile.metadata.cidText();
+
         if (!aid.isEmpty() && !cid.isEmpty()) {
-            downloadSubtitle(aid, cid, subtitleDir);
+            m_postProcessor->submit(QString("字幕 %1").arg(baseName),
+                [this, aid, cid, outputDir, baseName](QString &error) {
+                    TraceSpan span(&m_trace, "post.subtitle", QString("%1/%2").arg(aid, cid));
+                    if (!downloadSubtitle(aid, cid, outputDir, baseName)) {
+                        error = QString("下载失败: aid=%1, cid=%2").arg(aid, cid);
+                        return false;
+                    }
+                    return true;
+                });
         }
     }
-
-    // 合并视频
-    if (videoFile.isBlvFormat) {
-        return mergeBLVFiles(videoFile, outputPath);
-    } else {
-        return mergeVideoAudio(videoFile, outputPath);
-    }
 }
 
 bool MergeThread::mergeBLVFiles(const FileScanner::VideoFile &videoFile, const QString &outputPath)
@@ -238,17 +631,45 @@ bool MergeThread::mergeBLVFiles(const FileScanner::VideoFile &videoFile, const Q
         return false;
     }
 
-    // BLV文件处理：单个文件或使用concat
+    if (videoFile.blvFiles.isEmpty()) {
+        emit errorOccurred(QString("BLV文件列表为空: %1").arg(videoFile.entryPath));
+        return false;
+    }
+
+    QStringList arguments;
+
+    // BLV文件处理：单个文件直接转换容器
+    // 进度百分比按各分段时长之和计算
+    double duration = 0.0;
+    for (const QString &blvFile : videoFile.blvFiles) {
+        duration += m_ffmpegManager->mediaDuration(blvFile);
+    }
+
     if (videoFile.blvFiles.size() == 1) {
-        // 单个BLV文件直接复制
-        QString blvPath = videoFile.blvFiles.first();
-        double progress = 0.0;
-        return m_ffmpegManager->mergeSingleBLV(blvPath, outputPath, progress);
-    } else {
-        // 多个BLV文件使用concat
-        double progress = 0.0;
-        return m_ffmpegManager->mergeBLVFiles(videoFile.blvFiles, outputPath, progress);
+        arguments << "-i" << videoFile.blvFiles.first() << "-c" << "copy" << "-f" << "mp4" << "-y" << outputPath;
+        return runFfmpeg(arguments, duration, QStringList() << jobKey(videoFile));
     }
+
+    // 多个BLV文件使用concat，列表文件需保留到FFmpeg结束
+    QTemporaryFile concatFile(QDir::temp().filePath("blv_concat_XXXXXX.txt"));
+    if (!concatFile.open()) {
+        emit errorOccurred("无法创建临时concat文件");
+        return false;
+    }
+
+    QTextStream out(&concatFile);
+    out.setEncoding(QStringConverter::Utf8);
+    for (const QString &blvFile : videoFile.blvFiles) {
+        QString escaped = blvFile;
+        escaped.replace("'", "'\\''");
+        out << "file '" << escaped << "'\n";
+    }
+    out.flush();
+    concatFile.close();
+
+    arguments << "-f" << "concat" << "-safe" << "0" << "-i" << concatFile.fileName()
+              << "-c" << "copy" << "-f" << "mp4" << "-y" << outputPath;
+    return runFfmpeg(arguments, duration, QStringList() << jobKey(videoFile));
 }
 
 bool MergeThread::mergeVideoAudio(const FileScanner::VideoFile &videoFile, const QString &outputPath)
@@ -268,8 +689,192 @@ bool MergeThread::mergeVideoAudio(const FileScanner::VideoFile &videoFile, const
         return false;
     }
 
-    double progress = 0.0;
-    return m_ffmpegManager->mergeVideoAudio(videoFile.videoPath, videoFile.audioPath, outputPath, progress);
+    // 扫描时已探测过，这里直接命中缓存
+    MediaInfoCache *mediaInfo = m_ffmpegManager->mediaInfo();
+    MediaInfo videoInfo = mediaInfo->info(videoFile.videoPath);
+    MediaInfo audioInfo = mediaInfo->info(videoFile.audioPath);
+
+    QStringList arguments;
+    arguments << "-i" << videoFile.videoPath << "-i" << videoFile.audioPath;
+
+    // 只取视频文件的视频流和音频文件的音频流；无法探测时按原方式复制全部流
+    if (videoInfo.videoStreams > 0 && audioInfo.audioStreams > 0) {
+        arguments << "-map" << "0:v:0" << "-map" << "1:a:0";
+    }
+    arguments << "-c" << "copy";
+
+    // Hi-Res音轨为FLAC，较旧的FFmpeg写入MP4需要开启实验特性
+    if (audioInfo.audioCodec == "flac" || audioInfo.audioCodec == "opus") {
+        arguments << "-strict" << "experimental";
+    }
+    arguments << "-f" << "mp4" << "-y" << outputPath;
+
+    double duration = qMax(videoInfo.duration, audioInfo.duration);
+    return runFfmpeg(arguments, duration, QStringList() << jobKey(videoFile));
+}
+
+bool MergeThread::runFfmpeg(const QStringList &arguments, double durationSeconds, const QStringList &jobKeys,
+                            QString *errorLine)
+{
+    // executeFfmpeg使用局部进程同步执行，可在多个合并线程中同时调用；合并耗时与文件大小相关，不设超时
+    FfmpegManager::ExecOptions options;
+    options.timeoutMs = -1;
+    options.stallTimeoutMs = m_config.stallTimeoutMs;
+    options.durationSeconds = durationSeconds;
+    options.cancelRequested = [this]() {
+        return m_cancelRequested.load();
+    };
+    options.onProgress = [this, &jobKeys](const FfmpegProgress &progress) {
+        for (const QString &key : jobKeys) {
+            emit fileProgress(key, progress.percent(), progress.speed);
+        }
+    };
+
+    QString output, error;
+    if (!m_ffmpegManager->executeFfmpeg(arguments, output, error, options)) {
+        if (m_cancelRequested) {
+            return false;
+        }
+        QString lastLine = error.trimmed().section('\n', -1);
+        if (errorLine) {
+            *errorLine = lastLine;
+        } else {
+            emit errorOccurred(QString("FFmpeg执行失败: %1").arg(lastLine));
+        }
+        return false;
+    }
+    return true;
+}
+
+bool MergeThread::isBatchable(const FileScanner::VideoFile &videoFile, const MergeScheduler::Job &job)
+{
+    if (job.expectedBytes > m_config.batchMaxBytes || !m_ffmpegManager) {
+        return false;
+    }
+
+    // 批量时每个输出都要显式映射流，只处理已探测过、流明确的任务；多段BLV需要concat，单独处理
+    MediaInfoCache *mediaInfo = m_ffmpegManager->mediaInfo();
+    if (videoFile.isBlvFormat) {
+        return videoFile.blvFiles.size() == 1 && mediaInfo->info(videoFile.blvFiles.first()).valid;
+    }
+    return mediaInfo->info(videoFile.videoPath).videoStreams > 0
+           && mediaInfo->info(videoFile.audioPath).audioStreams > 0;
+}
+
+QList<QList<MergeScheduler::Job>> MergeThread::buildBatches(const QList<MergeScheduler::Job> &jobs)
+{
+    QList<QList<MergeScheduler::Job>> batches;
+    QList<MergeScheduler::Job> current;
+
+    for (const MergeScheduler::Job &job : jobs) {
+        const FileScanner::VideoFile &videoFile = m_videoGroups[job.groupIndex].files[job.fileIndex];
+        bool batchable = m_config.batchSize > 1 && isBatchable(videoFile, job);
+
+        // 同一批的输入需在同一块盘上，保持调度器的设备流计数准确
+        if (!current.isEmpty()
+            && (!batchable || current.size() >= m_config.batchSize
+                || current.first().inputDevice != job.inputDevice)) {
+            batches.append(current);
+            current.clear();
+        }
+
+        if (batchable) {
+            current.append(job);
+        } else {
+            batches.append(QList<MergeScheduler::Job>() << job);
+        }
+    }
+    if (!current.isEmpty()) {
+        batches.append(current);
+    }
+
+    return batches;
+}
+
+QList<bool> MergeThread::mergeBatch(const QList<DispatchItem> &items)
+{
+    QList<bool> results(items.size(), false);
+    MediaInfoCache *mediaInfo = m_ffmpegManager->mediaInfo();
+
+    QStringList inputs;
+    QStringList outputs;
+    QStringList keys;
+    int inputIndex = 0;
+    double duration = 0.0;
+
+    for (const DispatchItem &item : items) {
+        const FileScanner::VideoGroup &group = m_videoGroups[item.job.groupIndex];
+        const FileScanner::VideoFile &videoFile = group.files[item.job.fileIndex];
+
+        QDir outputDir = QFileInfo(item.outputPath).dir();
+        if (!outputDir.exists()) {
+            outputDir.mkpath(".");
+        }
+        schedulePostTasks(videoFile, item.outputPath, group.coverPath);
+        keys.append(item.key);
+
+        // 每个输出显式指定来源流，否则FFmpeg会从所有输入中挑选
+        if (videoFile.isBlvFormat) {
+            MediaInfo info = mediaInfo->info(videoFile.blvFiles.first());
+            inputs << "-i" << videoFile.blvFiles.first();
+            outputs << "-map" << QString("%1:v?").arg(inputIndex) << "-map" << QString("%1:a?").arg(inputIndex);
+            inputIndex += 1;
+            duration = qMax(duration, info.duration);
+        } else {
+            MediaInfo videoInfo = mediaInfo->info(videoFile.videoPath);
+            MediaInfo audioInfo = mediaInfo->info(videoFile.audioPath);
+            inputs << "-i" << videoFile.videoPath << "-i" << videoFile.audioPath;
+            outputs << "-map" << QString("%1:v:0").arg(inputIndex)
+                    << "-map" << QString("%1:a:0").arg(inputIndex + 1);
+            if (audioInfo.audioCodec == "flac" || audioInfo.audioCodec == "opus") {
+                outputs << "-strict" << "experimental";
+            }
+            inputIndex += 2;
+            duration = qMax(duration, qMax(videoInfo.duration, audioInfo.duration));
+        }
+        outputs << "-c" << "copy" << "-f" << "mp4" << MergeJournal::tempPathFor(item.outputPath);
+    }
+
+    // 各输出并行写出，进度按最长的一个计算
+    QString errorLine;
+    bool success;
+    {
+        TraceSpan span(&m_trace, "merge.ffmpeg_batch", items.first().outputPath);
+        QElapsedTimer ffmpegTimer;
+        ffmpegTimer.start();
+        success = runFfmpeg(QStringList() << "-y" << inputs << outputs, duration, keys, &errorLine);
+        m_metrics.observe("bilicache_ffmpeg_duration_seconds", ffmpegTimer.nsecsElapsed() / 1e9);
+    }
+
+    if (!success) {
+        for (const DispatchItem &item : items) {
+            QFile::remove(MergeJournal::tempPathFor(item.outputPath));
+        }
+        if (m_cancelRequested) {
+            return results;
+        }
+
+        // 无法确定是哪个文件出错，逐个重新合并以得到准确结果
+        emit logMessage(QString("批量合并 %1 个文件失败（%2），改为逐个合并").arg(items.size()).arg(errorLine));
+        for (int i = 0; i < items.size(); ++i) {
+            const DispatchItem &item = items[i];
+            TraceSpan span(&m_trace, "merge.job", item.outputPath);
+            results[i] = mergeToOutput(m_videoGroups[item.job.groupIndex].files[item.job.fileIndex],
+                                       item.outputPath);
+        }
+        return results;
+    }
+
+    for (int i = 0; i < items.size(); ++i) {
+        QString tempPath = MergeJournal::tempPathFor(items[i].outputPath);
+        if (Utils::replaceFile(tempPath, items[i].outputPath)) {
+            results[i] = true;
+        } else {
+            QFile::remove(tempPath);
+            emit errorOccurred(QString("无法写入输出文件: %1").arg(items[i].outputPath));
+        }
+    }
+    return results;
 }
 
 bool MergeThread::mergeAnyFormat(const QString &videoDir, const QString &outputFile)
@@ -356,8 +961,13 @@ bool MergeThread::mergeAnyFormat(const QString &videoDir, const QString &outputF
         emit logMessage("警告：未找到匹配的音视频文件，将使用最大的文件进行合并");
     }
 
-    // 检测音频格式，决定是否需要重编码
-    QString audioExt = QFileInfo(audioPath).suffix().toLower();
+    // 检测音频格式，决定是否需要重编码：优先用探测到的编码，无法探测时看扩展名
+    QString audioExt = m_ffmpegManager->mediaInfo()->info(audioPath).audioCodec;
+    if (audioExt.isEmpty()) {
+        audioExt = QFileInfo(audioPath).suffix().toLower();
+    } else if (audioExt.startsWith("pcm_")) {
+        audioExt = "wav";
+    }
     QStringList losslessFormats = {"flac", "ape", "wav", "cda"};
 
     QStringList arguments;
@@ -377,12 +987,13 @@ bool MergeThread::mergeAnyFormat(const QString &videoDir, const QString &outputF
     emit logMessage(QString("开始合并: %1 + %2").arg(QFileInfo(videoPath).fileName())
                                                    .arg(QFileInfo(audioPath).fileName()));
 
-    // 执行FFmpeg命令
-    QString output, error;
-    bool success = m_ffmpegManager->executeFfmpeg(arguments, output, error);
-
-    if (!success) {
-        emit errorOccurred(QString("合并失败: %1").arg(error));
+    // 执行FFmpeg命令：无损音频转码耗时与片长相关，不限总时长，只检测卡死
+    QString errorLine;
+    double duration = qMax(m_ffmpegManager->mediaDuration(videoPath), m_ffmpegManager->mediaDuration(audioPath));
+    if (!runFfmpeg(arguments, duration, QStringList() << videoDir, &errorLine)) {
+        if (!m_cancelRequested) {
+            emit errorOccurred(QString("合并失败: %1").arg(errorLine));
+        }
         return false;
     }
 
@@ -392,11 +1003,11 @@ bool MergeThread::mergeAnyFormat(const QString &videoDir, const QString &outputF
 
 QString MergeThread::generateOutputPath(const FileScanner::VideoFile &videoFile, const QString &baseDir)
 {
-    QString title = videoFile.metadata.value("title").toString();
-    QString partTitle = videoFile.metadata.value("part_title").toString();
+    QString title = videoFile.metadata.title;
+    QString partTitle = videoFile.metadata.partTitle;
 
     if (m_config.ordered && !partTitle.isEmpty()) {
-        QString partId = videoFile.metadata.value("part_id").toString();
+        QString partId = videoFile.metadata.partId;
         if (!partId.isEmpty()) {
             partTitle = QString("%1_%2").arg(partId, partTitle);
         }
@@ -408,17 +1019,63 @@ QString MergeThread::generateOutputPath(const FileScanner::VideoFile &videoFile,
 
     partTitle = cleanFileName(partTitle);
 
-    // 处理文件名冲突
-    QString finalName = partTitle;
-    if (!m_config.overwrite) {
-        int counter = 1;
-        QString baseName = finalName;
-        while (QFile::exists(QDir(baseDir).filePath(finalName + ".mp4"))) {
-            finalName = QString("%1(%2)").arg(baseName).arg(counter++);
+    // 处理文件名冲突：查表分配，并发合并时也不会分到同一个名字
+    QString finalName = reserveOutputName(baseDir, partTitle);
+
+    return QDir(baseDir).filePath(finalName + ".mp4");
+}
+
+QString MergeThread::reserveOutputName(const QString &dir, const QString &baseName)
+{
+    // Windows文件系统不区分大小写
+    auto nameKey = [](const QString &fileName) {
+#ifdef Q_OS_WINDOWS
+        return fileName.toLower();
+#else
+        return fileName;
+#endif
+    };
+
+    QString dirKey = QDir::cleanPath(QFileInfo(dir).absoluteFilePath());
+
+    QMutexLocker locker(&m_nameMutex);
+
+    auto it = m_nameTables.find(dirKey);
+    if (it == m_nameTables.end()) {
+        NameTable table;
+        // 不覆盖时避开目录中已有的文件；覆盖模式只避开本次运行分配的名字
+        if (!m_config.overwrite) {
+            const QStringList existing = QDir(dir).entryList(QStringList() << "*.mp4", QDir::Files);
+            for (const QString &fileName : existing) {
+                table.taken.insert(nameKey(fileName));
+            }
+        }
+        // 日志中其他任务已分配的名字（续传时沿用）
+        for (const QString &fileName : m_journalNames.value(dirKey)) {
+            table.taken.insert(nameKey(fileName));
         }
+        it = m_nameTables.insert(dirKey, table);
     }
 
-    return QDir(baseDir).filePath(finalName + ".mp4");
+    NameTable &table = it.value();
+    int &next = table.nextSuffix[nameKey(baseName)];
+
+    QString finalName = baseName;
+    if (next == 0) {
+        next = 1;
+        if (!table.taken.contains(nameKey(finalName + ".mp4"))) {
+            table.taken.insert(nameKey(finalName + ".mp4"));
+            return finalName;
+        }
+    }
+
+    // 序号只增不减，同名文件越多也不会重复探测
+    do {
+        finalName = QString("%1(%2)").arg(baseName).arg(next++);
+    } while (table.taken.contains(nameKey(finalName + ".mp4")));
+
+    table.taken.insert(nameKey(finalName + ".mp4"));
+    return finalName;
 }
 
 QString MergeThread::cleanFileName(const QString &fileName)
@@ -433,28 +1090,31 @@ QString MergeThread::cleanFileName(const QString &fileName)
     return cleaned;
 }
 
-bool MergeThread::downloadCover(const QString &coverUrl, const QString &outputPath)
+bool MergeThread::downloadCover(const QString &coverUrl, const QString &outputPath, QString &error)
 {
-    Q_UNUSED(coverUrl);
-    Q_UNUSED(outputPath);
-    // TODO: 实现封面下载
-    return true;
+    // 同一URL在本次合并中只请求一次，其余分集共享下载结果
+    return m_coverCache->fetch(coverUrl, outputPath, error);
 }
 
-bool MergeThread::downloadSubtitle(const QString &aid, const QString &cid, const QString &outputDir)
+bool MergeThread::downloadSubtitle(const QString &aid, const QString &cid,
+                                   const QString &outputDir, const QString &baseName)
 {
-    if (!m_subtitleDownloader) {
+    // 在后处理线程中执行：下载器需要属于当前线程，并由局部事件循环驱动
+    SubtitleDownloader downloader;
+    QEventLoop loop;
+    bool success = false;
+
+    connect(&downloader, &SubtitleDownloader::downloadFinished, &loop,
+            [&loop, &success](bool ok) {
+                success = ok;
+                loop.quit();
+            });
+
+    if (!downloader.downloadSubtitles(aid, cid, outputDir, baseName)) {
         return false;
     }
 
-    QDir dir(outputDir);
-    if (!dir.exists()) {
-        dir.mkpath(".");
-    }
-
-    QString baseName = "subtitle";
-    bool success = m_subtitleDownloader->downloadSubtitles(aid, cid, outputDir, baseName);
-
+    loop.exec();
     return success;
 }
 
@@ -469,7 +1129,7 @@ bool MergeThread::convertDanmaku(const QString &danmuPath, const QString &output
         outputDir.mkpath(".");
     }
 
-    DanmakuConverter::DanmakuConfig config;
+    DanmakuConfig config;
     config.fontSize = 25;
     config.textOpacity = 0.6;
     config.durationMarquee = 12.0;
@@ -480,7 +1140,87 @@ bool MergeThread::convertDanmaku(const QString &danmuPath, const QString &output
     config.stageHeight = 720;
     config.fontFace = "sans-serif";
 
-    return m_danmakuConverter->convertToASS(danmuPath, outputPath, config);
+    QElapsedTimer timer;
+    timer.start();
+    int commentCount = 0;
+    if (!m_danmakuConverter->convertToASS(danmuPath, outputPath, config, &commentCount)) {
+        return false;
+    }
+
+    m_metrics.increment("bilicache_danmaku_items_total", commentCount);
+    m_metrics.increment("bilicache_danmaku_duration_seconds_total", timer.nsecsElapsed() / 1e9);
+    double seconds = m_metrics.value("bilicache_danmaku_duration_seconds_total");
+    if (seconds > 0) {
+        m_metrics.set("bilicache_danmaku_items_per_second",
+                      m_metrics.value("bilicache_danmaku_items_total") / seconds);
+    }
+    return true;
+}
+
+void MergeThread::defineMetrics()
+{
+    m_metrics.defineGauge("bilicache_run_active", "是否有合并任务正在运行");
+    m_metrics.defineGauge("bilicache_run_start_timestamp_seconds", "本次运行开始时间");
+    m_metrics.defineGauge("bilicache_last_update_timestamp_seconds", "指标文件最后写入时间");
+    m_metrics.defineGauge("bilicache_scan_duration_seconds", "扫描耗时");
+    m_metrics.defineCounter("bilicache_files_scanned_total", "扫描到的视频数");
+    m_metrics.defineGauge("bilicache_files", "本次运行的视频总数");
+    m_metrics.defineGauge("bilicache_files_processed", "已处理的视频数（含失败和续传跳过）");
+    m_metrics.defineCounter("bilicache_merges_total", "合并结果计数");
+    m_metrics.defineCounter("bilicache_bytes_read_total", "成功合并的输入字节数");
+    m_metrics.defineCounter("bilicache_bytes_written_total", "成功合并的输出字节数");
+    m_metrics.defineHistogram("bilicache_ffmpeg_duration_seconds", "单次FFmpeg合并耗时",
+                              {1, 5, 15, 30, 60, 120, 300, 600, 1800, 3600});
+    m_metrics.defineCounter("bilicache_danmaku_items_total", "转换的弹幕条数");
+    m_metrics.defineCounter("bilicache_danmaku_duration_seconds_total", "弹幕转换累计耗时");
+    m_metrics.defineGauge("bilicache_danmaku_items_per_second", "弹幕转换平均速度");
+}
+
+void MergeThread::updateMetricsFile(bool force)
+{
+    if (m_config.metricsPath.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_metricsMutex);
+    if (!force && m_metricsTimer.isValid()
+        && m_metricsTimer.elapsed() < m_config.metricsIntervalMs) {
+        return;
+    }
+    m_metricsTimer.start();
+
+    m_metrics.set("bilicache_last_update_timestamp_seconds", QDateTime::currentSecsSinceEpoch());
+    QString error;
+    if (!m_metrics.writeTextfile(m_config.metricsPath, error)) {
+        emit logMessage(error);
+    }
+}
+
+int MergeThread::metricsWaitMs() const
+{
+    // 未启用指标文件时无需定期唤醒（-1表示一直等待）
+    if (m_config.metricsPath.isEmpty()) {
+        return -1;
+    }
+    return qMax(1000, m_config.metricsIntervalMs);
+}
+
+void MergeThread::reportTrace()
+{
+    // 附属任务结束后才汇总，保证记录完整
+    emit logMessage(QString("耗时统计（总计 %1 秒）:").arg(m_trace.now() / 1e9, 0, 'f', 1));
+    for (const QString &line : m_trace.summary()) {
+        emit logMessage(line);
+    }
+
+    if (!m_config.tracePath.isEmpty()) {
+        QString error;
+        if (m_trace.writeChromeTrace(m_config.tracePath, error)) {
+            emit logMessage(QString("性能记录已保存: %1").arg(m_config.tracePath));
+        } else {
+            emit logMessage(error);
+        }
+    }
 }
 
 void MergeThread::waitIfPaused()
@@ -7,14 +7,26 @@
 #include <QStringList>
 #include <QVariantMap>
 #include <QList>
+#include <QHash>
+#include <QSet>
 #include <QMutex>
 #include <QWaitCondition>
+#include <QElapsedTimer>
 #include <functional>
+#include <atomic>
+#include "FileScanner.h"
+#include "MergeScheduler.h"
+#include "TraceRecorder.h"
+#include "MetricsRegistry.h"
 
 class ConfigManager;
+class PatternManager;
 class FfmpegManager;
 class DanmakuConverter;
-class SubtitleDownloader;
+class PostProcessor;
+class CoverCache;
+class MergeJournal;
+class QThreadPool;
 
 /**
  * @brief 合并线程类
@@ -41,20 +53,35 @@ public:
         bool ordered;               // 分P编号
         bool overwrite;             // 覆盖模式
         bool errorSkip;             // 错误跳过
+        int postWorkers = 2;        // 附属任务（封面/弹幕/字幕）线程数
+        int concurrency = 2;        // 同时进行的合并任务数
+        int streamsPerDevice = 2;   // 输入输出不在同一块磁盘时，每块磁盘的并发读写流数（同盘时只受concurrency限制）
+        qint64 reserveBytes = 512LL * 1024 * 1024;  // 目标卷需保留的剩余空间
+        int stallTimeoutMs = 120000;    // FFmpeg进度停滞超过此时间视为卡死并终止（0为不检测）
+        int batchSize = 8;          // 小文件批量合并时一次FFmpeg调用处理的最多任务数（<=1为不批量）
+        qint64 batchMaxBytes = 64LL * 1024 * 1024;  // 不超过此大小的任务才参与批量合并
+        bool probeMedia = true;     // 扫描时用ffprobe检查媒体文件（可发现下载不完整的文件）
+        bool writeRepairedJson = false; // 扫描时把修复后的entry文件写回磁盘
+        QString tracePath;          // 非空时将各阶段耗时导出为Chrome trace JSON
+        QString metricsPath;        // 非空时定期写入Prometheus指标文件（node_exporter textfile）
+        int metricsIntervalMs = 15000;  // 指标文件最短写入间隔
     };
 
     // 设置配置
     void setConfig(const MergeConfig &config);
     void setConfigManager(ConfigManager *manager);
     void setFfmpegManager(FfmpegManager *manager);
+    void setPatternManager(PatternManager *manager);
     void setDanmakuConverter(DanmakuConverter *converter);
-    void setSubtitleDownloader(SubtitleDownloader *downloader);
 
     // 线程控制
     void pause();
     void resume();
     void stop();
 
+    // 运行指标（可在任意线程读取）
+    const MetricsRegistry &metrics() const { return m_metrics; }
+
     // 状态查询
     bool isPaused() const { return m_paused; }
     bool isStopped() const { return m_stopped; }
@@ -71,6 +98,8 @@ signals:
     void errorOccurred(const QString &error);
     void mergeCompleted(int successCount, int failedCount);
     void fileMerged(const QString &outputPath);
+    // 单个合并任务的FFmpeg进度（在合并线程中发出），jobKey为缓存条目路径，percent未知时为-1
+    void fileProgress(const QString &jobKey, double percent, double speed);
     void statusChanged(const QString &status);
 
 protected:
@@ -78,18 +107,57 @@ protected:
 
 private:
     // 合并单个视频文件
-    bool mergeSingleVideo(const FileScanner::VideoFile &videoFile, const QString &outputDir);
+    bool mergeSingleVideo(const FileScanner::VideoFile &videoFile, const QString &outputPath,
+                          const QString &groupCoverPath);
     bool mergeBLVFiles(const FileScanner::VideoFile &videoFile, const QString &outputPath);
     bool mergeVideoAudio(const FileScanner::VideoFile &videoFile, const QString &outputPath);
     bool mergeAnyFormat(const QString &videoDir, const QString &outputFile);
+    bool mergeToOutput(const FileScanner::VideoFile &videoFile, const QString &outputPath);
+
+    // errorLine非空时FFmpeg的错误写入其中而不发出errorOccurred
+    bool runFfmpeg(const QStringList &arguments, double durationSeconds, const QStringList &jobKeys,
+                   QString *errorLine = nullptr);
+
+    // 小文件批量合并：多个任务共用一次FFmpeg调用（多输入多输出），分摊进程启动开销
+    struct DispatchItem {
+        MergeScheduler::Job job;
+        QString key;
+        QString outputPath;
+    };
+    bool isBatchable(const FileScanner::VideoFile &videoFile, const MergeScheduler::Job &job);
+    QList<QList<MergeScheduler::Job>> buildBatches(const QList<MergeScheduler::Job> &jobs);
+    QList<bool> mergeBatch(const QList<DispatchItem> &items);
+
+    // 合并日志中标识任务的键
+    static QString jobKey(const FileScanner::VideoFile &videoFile);
+
+    // 记录单个任务结果（可在合并线程中调用）
+    void finishJob(const MergeScheduler::Job &job, const QString &outputPath,
+                   bool success, const QString &reason);
+
+    // 附属任务（在后处理线程池中执行）
+    void schedulePostTasks(const FileScanner::VideoFile &videoFile, const QString &outputPath,
+                           const QString &groupCoverPath);
 
     // 辅助功能
     QString generateOutputPath(const FileScanner::VideoFile &videoFile, const QString &baseDir);
     QString cleanFileName(const QString &fileName);
-    bool downloadCover(const QString &coverUrl, const QString &outputPath);
-    bool downloadSubtitle(const QString &aid, const QString &cid, const QString &outputDir);
+
+    // 在输出目录的名称表中登记并返回不重复的文件名（不含扩展名）
+    QString reserveOutputName(const QString &dir, const QString &baseName);
+    bool downloadCover(const QString &coverUrl, const QString &outputPath, QString &error);
+    bool downloadSubtitle(const QString &aid, const QString &cid,
+                          const QString &outputDir, const QString &baseName);
     bool convertDanmaku(const QString &danmuPath, const QString &outputPath);
 
+    // 运行指标
+    void defineMetrics();
+    void updateMetricsFile(bool force);
+    int metricsWaitMs() const;
+
+    // 输出各阶段耗时汇总，并按配置导出trace文件
+    void reportTrace();
+
     // 等待和通知
     void waitIfPaused();
 
@@ -97,8 +165,17 @@ private:
     MergeConfig m_config;
     ConfigManager *m_configManager;
     FfmpegManager *m_ffmpegManager;
+    PatternManager *m_patternManager;
     DanmakuConverter *m_danmakuConverter;
-    SubtitleDownloader *m_subtitleDownloader;
+    PostProcessor *m_postProcessor;
+    CoverCache *m_coverCache;
+    QThreadPool *m_mergePool;
+    MergeJournal *m_journal;        // 中断续传日志
+    MergeScheduler m_scheduler;
+    TraceRecorder m_trace;          // 各阶段耗时
+    MetricsRegistry m_metrics;      // 运行指标
+    QElapsedTimer m_metricsTimer;   // 距上次写指标文件的时间
+    QMutex m_metricsMutex;
 
     QList<FileScanner::VideoGroup> m_videoGroups;
     int m_currentIndex;
@@ -107,9 +184,20 @@ private:
     int m_failedCount;
 
     mutable QMutex m_mutex;
+
+    // 每个输出目录的文件名占用表，首次使用时由一次目录列举初始化
+    struct NameTable {
+        QSet<QString> taken;                // 已占用的文件名
+        QHash<QString, int> nextSuffix;     // 各基础名下一个可尝试的序号
+    };
+    QHash<QString, NameTable> m_nameTables;
+    QHash<QString, QStringList> m_journalNames;     // 目录 -> 日志中已分配的文件名，run()开始时由日志建立一次
+    QMutex m_nameMutex;
     QWaitCondition m_waitCondition;
     bool m_paused;
-    bool m_stopped;
+    std::atomic<bool> m_stopped;            // stop()持锁写入，派发循环不持锁读取
+    std::atomic<bool> m_abortRequested;     // 出错且未启用错误跳过时停止派发，合并任务中写入
+    std::atomic<bool> m_cancelRequested;    // stop()后终止正在运行的FFmpeg
 
     // 线程完成回调钩子
     std::function<void(bool)> m_completionHook;
@@ -0,0 +1,177 @@
+#include "MetricsRegistry.h"
+#include <QSaveFile>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+
+MetricsRegistry::MetricsRegistry()
+{
+}
+
+void MetricsRegistry::defineCounter(const QString &name, const QString &help)
+{
+    define(name, Counter, help, QList<double>());
+}
+
+void MetricsRegistry::defineGauge(const QString &name, const QString &help)
+{
+    define(name, Gauge, help, QList<double>());
+}
+
+void MetricsRegistry::defineHistogram(const QString &name, const QString &help, const QList<double> &buckets)
+{
+    QList<double> sorted = buckets;
+    std::sort(sorted.begin(), sorted.end());
+    define(name, Histogram, help, sorted);
+}
+
+void MetricsRegistry::define(const QString &name, Type type, const QString &help, const QList<double> &buckets)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_families.contains(name)) {
+        return;
+    }
+
+    Family family;
+    family.type = type;
+    family.help = help;
+    family.buckets = buckets;
+    // 最后一个区间对应 +Inf
+    family.bucketCounts = QList<quint64>(buckets.size() + 1, 0);
+    m_families.insert(name, family);
+}
+
+void MetricsRegistry::increment(const QString &name, double value, const QString &labels)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_families.find(name);
+    if (it == m_families.end() || it->type == Histogram) {
+        return;
+    }
+    it->samples[labels] += value;
+}
+
+void MetricsRegistry::set(const QString &name, double value, const QString &labels)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_families.find(name);
+    if (it == m_families.end() || it->type == Histogram) {
+        return;
+    }
+    it->samples[labels] = value;
+}
+
+void MetricsRegistry::observe(const QString &name, double value)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_families.find(name);
+    if (it == m_families.end() || it->type != Histogram) {
+        return;
+    }
+
+    int index = static_cast<int>(std::lower_bound(it->buckets.begin(), it->buckets.end(), value)
+                                 - it->buckets.begin());
+    it->bucketCounts[index]++;
+    it->sum += value;
+    it->count++;
+}
+
+double MetricsRegistry::value(const QString &name, const QString &labels) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_families.constFind(name);
+    if (it == m_families.constEnd()) {
+        return 0.0;
+    }
+    if (it->type == Histogram) {
+        return static_cast<double>(it->count);
+    }
+    return it->samples.value(labels, 0.0);
+}
+
+void MetricsRegistry::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    for (Family &family : m_families) {
+        family.samples.clear();
+        family.bucketCounts.fill(0);
+        family.sum = 0.0;
+        family.count = 0;
+    }
+}
+
+QByteArray MetricsRegistry::exposition() const
+{
+    static const char *typeNames[] = {"counter", "gauge", "histogram"};
+
+    QMutexLocker locker(&m_mutex);
+    QByteArray out;
+
+    for (auto it = m_families.constBegin(); it != m_families.constEnd(); ++it) {
+        QByteArray name = it.key().toUtf8();
+        const Family &family = it.value();
+
+        out += "# HELP " + name + " " + family.help.toUtf8() + "\n";
+        out += "# TYPE " + name + " " + typeNames[family.type] + "\n";
+
+        if (family.type == Histogram) {
+            quint64 cumulative = 0;
+            for (int i = 0; i < family.buckets.size(); ++i) {
+                cumulative += family.bucketCounts[i];
+                out += name + "_bucket{le=\"" + formatValue(family.buckets[i]) + "\"} "
+                       + QByteArray::number(cumulative) + "\n";
+            }
+            out += name + "_bucket{le=\"+Inf\"} " + QByteArray::number(family.count) + "\n";
+            out += name + "_sum " + formatValue(family.sum) + "\n";
+            out += name + "_count " + QByteArray::number(family.count) + "\n";
+            continue;
+        }
+
+        // 尚未更新的计数器也输出0，告警规则不会因缺少序列而失效
+        if (family.samples.isEmpty()) {
+            out += name + " 0\n";
+            continue;
+        }
+        for (auto sample = family.samples.constBegin(); sample != family.samples.constEnd(); ++sample) {
+            out += name;
+            if (!sample.key().isEmpty()) {
+                out += "{" + sample.key().toUtf8() + "}";
+            }
+            out += " " + formatValue(sample.value()) + "\n";
+        }
+    }
+
+    return out;
+}
+
+bool MetricsRegistry::writeTextfile(const QString &filePath, QString &error) const
+{
+    QByteArray data = exposition();
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = QString("无法写入指标文件: %1").arg(filePath);
+        return false;
+    }
+    file.write(data);
+    if (!file.commit()) {
+        error = QString("无法保存指标文件: %1").arg(filePath);
+        return false;
+    }
+    return true;
+}
+
+QByteArray MetricsRegistry::formatValue(double value)
+{
+    if (std::isinf(value)) {
+        return value > 0 ? "+Inf" : "-Inf";
+    }
+    if (std::isnan(value)) {
+        return "NaN";
+    }
+    // 整数值（字节数、计数）不使用科学计数法
+    if (value == std::floor(value) && std::fabs(value) < 1e15) {
+        return QByteArray::number(static_cast<qint64>(value));
+    }
+    return QByteArray::number(value, 'g', 10);
+}
@@ -0,0 +1,64 @@
+#ifndef METRICSREGISTRY_H
+#define METRICSREGISTRY_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+
+/**
+ * @brief 运行指标注册表
+ * 计数器、瞬时值和直方图，输出Prometheus文本格式，
+ * 可定期写成node_exporter textfile collector读取的.prom文件
+ *
+ * 指标需先定义再使用，未定义的名称会被忽略；可在多个线程中同时更新
+ */
+class MetricsRegistry
+{
+public:
+    MetricsRegistry();
+
+    // 定义指标（重复定义时保留已有数据）
+    void defineCounter(const QString &name, const QString &help);
+    void defineGauge(const QString &name, const QString &help);
+    void defineHistogram(const QString &name, const QString &help, const QList<double> &buckets);
+
+    // labels为Prometheus标签串，如 result="ok"
+    void increment(const QString &name, double value = 1.0, const QString &labels = QString());
+    void set(const QString &name, double value, const QString &labels = QString());
+    void observe(const QString &name, double value);
+
+    double value(const QString &name, const QString &labels = QString()) const;
+
+    // 清零所有数据，保留定义
+    void reset();
+
+    // Prometheus文本格式
+    QByteArray exposition() const;
+
+    // 原子替换写入，读取方不会看到写了一半的文件
+    bool writeTextfile(const QString &filePath, QString &error) const;
+
+private:
+    enum Type { Counter, Gauge, Histogram };
+
+    struct Family {
+        Type type;
+        QString help;
+        QMap<QString, double> samples;  // 标签串 -> 值
+        QList<double> buckets;          // 直方图上界（升序）
+        QList<quint64> bucketCounts;    // 各区间（非累计）计数
+        double sum = 0.0;
+        quint64 count = 0;
+    };
+
+    void define(const QString &name, Type type, const QString &help, const QList<double> &buckets);
+    static QByteArray formatValue(double value);
+
+    mutable QMutex m_mutex;
+    QMap<QString, Family> m_families;
+};
+
+#endif // METRICSREGISTRY_H
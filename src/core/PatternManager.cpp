@@ -29,6 +29,7 @@ void PatternManager::initializePatternPath()
 bool PatternManager::loadAllPatterns()
 {
     m_patterns.clear();
+    m_compiledPatterns.clear();
 
     QDir patternDir(m_patternPath);
     if (!patternDir.exists()) {
@@ -92,6 +93,7 @@ bool PatternManager::loadPatternFile(const QString &filePath)
     }
 
     m_patterns[name] = pattern;
+    m_compiledPatterns[name] = CompiledPattern::compile(pattern);
     return true;
 }
 
@@ -175,6 +177,11 @@ QMap<QString, QVariantMap> PatternManager::patterns() const
     return m_patterns;
 }
 
+QMap<QString, CompiledPattern> PatternManager::compiledPatterns() const
+{
+    return m_compiledPatterns;
+}
+
 QStringList PatternManager::patternNames() const
 {
     return m_patterns.keys();
@@ -208,64 +215,6 @@ QString PatternManager::resolvePathTemplate(const QString &templateStr, const QV
     return result;
 }
 
-QVariantMap PatternManager::parseMetadata(const QString &entryFilePath, const QVariantMap &parseRules) const
-{
-    QVariantMap metadata;
-
-    // 读取entry.json文件
-    QFile entryFile(entryFilePath);
-    if (!entryFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return metadata;
-    }
-
-    QByteArray jsonData = entryFile.readAll();
-    entryFile.close();
-
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(jsonData, &parseError);
-    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
-        return metadata;
-    }
-
-    QJsonObject jsonObj = doc.object();
-
-    // 根据parse规则提取元数据
-    for (auto it = parseRules.begin(); it != parseRules.end(); ++it) {
-        QString field = it.key();
-        QString jsonPath = it.value().toString();
-
-        if (!jsonPath.isEmpty()) {
-            QVariant value = getValueFromJsonPath(jsonObj, jsonPath);
-            if (!value.isNull()) {
-                metadata[field] = value;
-            }
-        }
-    }
-
-    return metadata;
-}
-
-QVariant PatternManager::getValueFromJsonPath(const QJsonObject &jsonObj, const QString &path) const
-{
-    if (path.isEmpty()) {
-        return QVariant();
-    }
-
-    // 处理多级路径，如 "page_data-cid"
-    QStringList parts = path.split('-');
-    QJsonValue current = jsonObj;
-
-    for (const QString &part : parts) {
-        if (current.isObject()) {
-            current = current.toObject().value(part);
-        } else {
-            return QVariant(); // 路径无效
-        }
-    }
-
-    return current.toVariant();
-}
-
 QVariantMap PatternManager::convertJsonObjectToVariantMap(const QJsonObject &jsonObj) const
 {
     QVariantMap result;
@@ -9,6 +9,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include "CompiledPattern.h"
 
 class ConfigManager;
 
@@ -56,6 +57,7 @@ public:
     bool loadAllPatterns();
     bool loadPatternByName(const QString &name);
     QMap<QString, QVariantMap> patterns() const;
+    QMap<QString, CompiledPattern> compiledPatterns() const;   // 扫描用，加载时编译一次
     QStringList patternNames() const;
 
     // 模式验证
@@ -64,7 +66,6 @@ public:
 
     // 路径模板处理
     QString resolvePathTemplate(const QString &templateStr, const QVariantMap &metadata) const;
-    QVariantMap parseMetadata(const QString &entryFilePath, const QVariantMap &parseRules) const;
 
 signals:
     void patternsLoaded();
@@ -74,12 +75,12 @@ private:
     void initializePatternPath();
     bool loadPatternFile(const QString &filePath);
     QVariantMap parseJsonFile(const QString &filePath);
-    QVariant getValueFromJsonPath(const QJsonObject &jsonObj, const QString &path) const;
     QVariantMap convertJsonObjectToVariantMap(const QJsonObject &jsonObj) const;
 
     ConfigManager* m_configManager;
     QString m_patternPath;
     QMap<QString, QVariantMap> m_patterns;
+    QMap<QString, CompiledPattern> m_compiledPatterns;
 };
 
 #endif // PATTERNMANAGER_H
\ No newline at end of file
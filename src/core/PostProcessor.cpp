@@ -0,0 +1,118 @@
+#include "PostProcessor.h"
+#include <QDeadlineTimer>
+#include <QMutexLocker>
+
+PostProcessor::PostProcessor(QObject *parent)
+    : QObject(parent)
+    , m_generation(0)
+    , m_pending(0)
+    , m_succeeded(0)
+    , m_failed(0)
+{
+    // 附属任务以网络等待为主，少量线程即可
+    m_pool.setMaxThreadCount(2);
+}
+
+PostProcessor::~PostProcessor()
+{
+    cancelPending();
+    waitForDone();
+}
+
+void PostProcessor::setMaxWorkers(int count)
+{
+    m_pool.setMaxThreadCount(qMax(1, count));
+}
+
+int PostProcessor::maxWorkers() const
+{
+    return m_pool.maxThreadCount();
+}
+
+void PostProcessor::submit(const QString &name, Task task)
+{
+    quint64 generation;
+    {
+        QMutexLocker locker(&m_mutex);
+        ++m_pending;
+        generation = m_generation;
+    }
+
+    m_pool.start([this, name, task, generation]() {
+        if (isCancelled(generation)) {
+            taskDone(Cancelled);
+            return;
+        }
+
+        QString error;
+        bool success = task(error);
+
+        emit taskFinished(name, success, error);
+        taskDone(success ? Succeeded : Failed);
+    });
+}
+
+void PostProcessor::cancelPending()
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_generation;
+}
+
+bool PostProcessor::waitForDone(int msecs)
+{
+    QDeadlineTimer deadline = msecs < 0 ? QDeadlineTimer(QDeadlineTimer::Forever)
+                                        : QDeadlineTimer(msecs);
+
+    QMutexLocker locker(&m_mutex);
+    while (m_pending > 0) {
+        if (!m_idleCondition.wait(&m_mutex, deadline)) {
+            break;
+        }
+    }
+    return m_pending == 0;
+}
+
+int PostProcessor::pendingCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pending;
+}
+
+int PostProcessor::succeededCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_succeeded;
+}
+
+int PostProcessor::failedCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_failed;
+}
+
+void PostProcessor::resetCounters()
+{
+    QMutexLocker locker(&m_mutex);
+    m_succeeded = 0;
+    m_failed = 0;
+}
+
+bool PostProcessor::isCancelled(quint64 generation) const
+{
+    QMutexLocker locker(&m_mutex);
+    return generation != m_generation;
+}
+
+void PostProcessor::taskDone(TaskOutcome outcome)
+{
+    QMutexLocker locker(&m_mutex);
+    if (outcome == Succeeded) {
+        m_succeeded++;
+    } else if (outcome == Failed) {
+        m_failed++;
+    }
+
+    if (--m_pending == 0) {
+        m_idleCondition.wakeAll();
+    }
+}
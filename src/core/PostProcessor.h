@@ -0,0 +1,67 @@
+#ifndef POSTPROCESSOR_H
+#define POSTPROCESSOR_H
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QMutex>
+#include <QWaitCondition>
+#include <functional>
+
+/**
+ * @brief 后处理阶段
+ * 封面、弹幕、字幕等附属任务在独立的小线程池中异步执行，
+ * 与FFmpeg合并并行进行，不占用视频合并的关键路径
+ *
+ * 单个任务失败只通过taskFinished信号报告，不会阻塞后续合并
+ */
+class PostProcessor : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 附属任务：返回是否成功，失败原因写入error
+    using Task = std::function<bool(QString &error)>;
+
+    explicit PostProcessor(QObject *parent = nullptr);
+    ~PostProcessor();
+
+    // 线程池大小
+    void setMaxWorkers(int count);
+    int maxWorkers() const;
+
+    // 提交任务（立即返回）
+    void submit(const QString &name, Task task);
+
+    // 丢弃尚未开始的任务
+    void cancelPending();
+
+    // 等待所有任务完成，msecs < 0 表示一直等待
+    bool waitForDone(int msecs = -1);
+
+    // 统计
+    int pendingCount() const;
+    int succeededCount() const;
+    int failedCount() const;
+    void resetCounters();
+
+signals:
+    // 在工作线程中发出，接收方需自行处理线程切换
+    void taskFinished(const QString &name, bool success, const QString &error);
+
+private:
+    enum TaskOutcome { Succeeded, Failed, Cancelled };
+
+    bool isCancelled(quint64 generation) const;
+    void taskDone(TaskOutcome outcome);
+
+    QThreadPool m_pool;
+    mutable QMutex m_mutex;
+    QWaitCondition m_idleCondition;
+    quint64 m_generation;
+    int m_pending;
+    int m_succeeded;
+    int m_failed;
+};
+
+#endif // POSTPROCESSOR_H
@@ -50,6 +50,7 @@ bool SubtitleDownloader::downloadSubtitles(const QString &aid, const QString &ci
         emit downloadLog("错误：API请求失败");
         return false;
     }
+    connect(m_apiReply, &QNetworkReply::finished, this, &SubtitleDownloader::onApiReplyFinished);
 
     // 设置超时（5秒）
     m_timeoutTimer->start(5000);
@@ -99,6 +100,7 @@ void SubtitleDownloader::onApiReplyFinished()
     if (m_apiReply->error() != QNetworkReply::NoError) {
         emit downloadLog(QString("网络错误: %1").arg(m_apiReply->errorString()));
         cleanup();
+        emit downloadFinished(false);
         return;
     }
 
@@ -108,6 +110,7 @@ void SubtitleDownloader::onApiReplyFinished()
     if (subtitles.isEmpty()) {
         emit downloadLog("未发现字幕数据");
         cleanup();
+        emit downloadFinished(true);
         return;
     }
 
@@ -137,9 +140,13 @@ void SubtitleDownloader::onApiReplyFinished()
         m_subtitleReply = downloadSubtitleData(firstSubtitle.url);
         if (m_subtitleReply) {
             m_subtitleReply->setProperty("filePath", filePath);
+            m_subtitleReply->setProperty("outputDir", outputDir);
+            m_subtitleReply->setProperty("baseName", baseName);
             m_subtitleReply->setProperty("subtitles", QVariant::fromValue(subtitles));
             m_subtitleReply->setProperty("currentIndex", 0);
             m_timeoutTimer->start(5000);
+        } else {
+            emit downloadFinished(false);
         }
     }
 
@@ -154,6 +161,7 @@ void SubtitleDownloader::onSubtitleReplyFinished()
     if (m_subtitleReply->error() != QNetworkReply::NoError) {
         emit downloadLog(QString("下载错误: %1").arg(m_subtitleReply->errorString()));
         cleanup();
+        emit downloadFinished(false);
         return;
     }
 
@@ -163,26 +171,26 @@ void SubtitleDownloader::onSubtitleReplyFinished()
     QString filePath = m_subtitleReply->property("filePath").toString();
 
     if (entries.isEmpty()) {
-        emit downloadLog("字幕数据为空");
-        m_subtitleReply->deleteLater();
-        m_subtitleReply = nullptr;
-        return;
-    }
-
-    emit downloadLog(QString("解析到 %1 条字幕").arg(entries.size()));
-
-    // 转换为SRT
-    if (convertToSRT(entries, filePath)) {
-        emit downloadLog(QString("字幕已保存: %1").arg(filePath));
-        emit downloadCompleted(true, filePath);
+        // 只跳过这一条，其余字幕继续下载
+        emit downloadLog(QString("字幕数据为空，跳过: %1").arg(filePath));
     } else {
-        emit downloadLog("转换失败");
-        emit downloadCompleted(false, filePath);
+        emit downloadLog(QString("解析到 %1 条字幕").arg(entries.size()));
+
+        // 转换为SRT
+        if (convertToSRT(entries, filePath)) {
+            emit downloadLog(QString("字幕已保存: %1").arg(filePath));
+            emit downloadCompleted(true, filePath);
+        } else {
+            emit downloadLog("转换失败");
+            emit downloadCompleted(false, filePath);
+        }
     }
 
-    // 检查是否还有更多字幕需要下载
+    // 检查是否还有更多字幕需要下载；输出位置随每个请求传递，不从上一个文件名推断
     QList<SubtitleItem> subtitles = m_subtitleReply->property("subtitles").value<QList<SubtitleItem>>();
     int currentIndex = m_subtitleReply->property("currentIndex").toInt();
+    QString outputDir = m_subtitleReply->property("outputDir").toString();
+    QString baseName = m_subtitleReply->property("baseName").toString();
 
     m_subtitleReply->deleteLater();
     m_subtitleReply = nullptr;
@@ -190,28 +198,29 @@ void SubtitleDownloader::onSubtitleReplyFinished()
     // 下载下一个字幕
     if (currentIndex + 1 < subtitles.size()) {
         SubtitleItem nextSubtitle = subtitles[currentIndex + 1];
-        QString outputDir = m_apiReply ? m_apiReply->property("outputDir").toString()
-                                       : QFileInfo(filePath).dir().path();
-        QString baseName = m_apiReply ? m_apiReply->property("baseName").toString()
-                                      : QFileInfo(filePath).baseName();
-
         QString nextFilePath = QString("%1/%2_%3.srt")
                               .arg(outputDir, baseName, nextSubtitle.language);
 
         m_subtitleReply = downloadSubtitleData(nextSubtitle.url);
         if (m_subtitleReply) {
             m_subtitleReply->setProperty("filePath", nextFilePath);
+            m_subtitleReply->setProperty("outputDir", outputDir);
+            m_subtitleReply->setProperty("baseName", baseName);
             m_subtitleReply->setProperty("subtitles", QVariant::fromValue(subtitles));
             m_subtitleReply->setProperty("currentIndex", currentIndex + 1);
             m_timeoutTimer->start(5000);
+            return;
         }
     }
+
+    emit downloadFinished(true);
 }
 
 void SubtitleDownloader::onTimeout()
 {
     emit downloadLog("请求超时");
     cleanup();
+    emit downloadFinished(false);
 }
 
 QList<SubtitleItem> SubtitleDownloader::parseApiResponse(const QByteArray &data)
@@ -263,7 +272,9 @@ QNetworkReply* SubtitleDownloader::downloadSubtitleData(const QString &url)
     request.setHeader(QNetworkRequest::UserAgentHeader,
                      "Mozilla/5.0 (Windows NT 10.0; Win64; x64; rv:67.0) Gecko/20100101 Firefox/67.0");
 
-    return m_networkManager->get(request);
+    QNetworkReply *reply = m_networkManager->get(request);
+    connect(reply, &QNetworkReply::finished, this, &SubtitleDownloader::onSubtitleReplyFinished);
+    return reply;
 }
 
 QList<SubtitleEntry> SubtitleDownloader::parseSubtitleJson(const QByteArray &data)
@@ -344,12 +355,14 @@ QString SubtitleDownloader::convertToSRTTime(double seconds)
 void SubtitleDownloader::cleanup()
 {
     if (m_apiReply) {
+        m_apiReply->disconnect(this);
         m_apiReply->abort();
         m_apiReply->deleteLater();
         m_apiReply = nullptr;
     }
 
     if (m_subtitleReply) {
+        m_subtitleReply->disconnect(this);
         m_subtitleReply->abort();
         m_subtitleReply->deleteLater();
         m_subtitleReply = nullptr;
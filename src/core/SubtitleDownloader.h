@@ -41,6 +41,7 @@ signals:
     void downloadProgress(int percent);
     void downloadLog(const QString &message);
     void downloadCompleted(bool success, const QString &filePath);
+    void downloadFinished(bool success);   // 整个下载流程结束（含失败）
 
 private slots:
     void onApiReplyFinished();
@@ -0,0 +1,346 @@
+#include "TolerantJsonReader.h"
+#include <QVector>
+#include <cstring>
+
+namespace {
+
+enum State {
+    ExpectKey,      // 对象中：'{'或','之后
+    ExpectColon,    // 对象中：键之后
+    ExpectValue,    // 对象中：':'之后；数组中：'['或','之后
+    ExpectComma     // 一个值结束之后
+};
+
+struct Frame {
+    char close;         // '}'或']'
+    State state;
+    int safeLength;     // 输出截到这里时本层内容完整（最后一个完整的值之后，或开括号之后）
+    int commaAt;        // 最后一个记号是逗号时它在输出中的位置，否则为-1
+};
+
+/**
+ * 输入中连续保留的部分不逐字节复制：只记住起点，需要删改时才把之前的部分一次追加到输出
+ */
+struct Reader {
+    const char *begin;
+    const char *pos;
+    const char *end;
+    const char *run;        // 尚未追加到输出的保留部分的起点
+    QByteArray out;
+    QVector<Frame> stack;
+    QStringList repairs;
+
+    explicit Reader(const QByteArray &data)
+        : begin(data.constData())
+        , pos(data.constData())
+        , end(data.constData() + data.size())
+        , run(data.constData())
+    {
+        out.reserve(data.size() + 16);
+    }
+
+    int offset() const { return int(pos - begin); }
+
+    // 输入读到pos时输出的逻辑长度
+    int outputLength() const { return out.size() + int(pos - run); }
+
+    void flush()
+    {
+        out.append(run, int(pos - run));
+        run = pos;
+    }
+
+    // 丢弃输入中[pos, to)
+    void drop(const char *to)
+    {
+        flush();
+        pos = to;
+        run = to;
+    }
+
+    void skipWhitespace()
+    {
+        while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r')) {
+            ++pos;
+        }
+    }
+
+    bool skipString()
+    {
+        // 调用时pos指向开头的引号
+        const char *from = pos + 1;
+        for (;;) {
+            const void *hit = std::memchr(from, '"', size_t(end - from));
+            if (!hit) {
+                return false;
+            }
+            const char *quote = static_cast<const char *>(hit);
+            int backslashes = 0;
+            for (const char *p = quote - 1; p > pos && *p == '\\'; --p) {
+                ++backslashes;
+            }
+            if (backslashes % 2 == 0) {
+                pos = quote + 1;
+                return true;
+            }
+            from = quote + 1;
+        }
+    }
+
+    const char *scalarEnd() const
+    {
+        const char *p = pos;
+        while (p < end) {
+            char c = *p;
+            if (c == ',' || c == ':' || c == '}' || c == ']' || c == '{' || c == '[' || c == '"'
+                || c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                break;
+            }
+            ++p;
+        }
+        return p;
+    }
+
+    void valueDone()
+    {
+        Frame &top = stack.last();
+        top.state = ExpectComma;
+        top.commaAt = -1;
+        top.safeLength = outputLength();
+    }
+
+    // 结束最内层：去掉末尾多余的逗号或不完整的成员。input为true时右括号来自输入，否则补在输出中
+    void closeTop(bool input)
+    {
+        Frame &top = stack.last();
+        if (top.commaAt >= 0) {
+            flush();
+            out.remove(top.commaAt, 1);
+            repairs.append(QString("删除了位置 %1 之前多余的逗号").arg(offset()));
+        } else if (top.state == ExpectColon || (top.close == '}' && top.state == ExpectValue)) {
+            flush();
+            out.truncate(top.safeLength);
+            repairs.append(QString("丢弃了位置 %1 之前不完整的成员").arg(offset()));
+        }
+
+        if (input) {
+            ++pos;
+        } else {
+            flush();
+            out.append(top.close);
+            repairs.append(QString("位置 %1 处补全了缺少的'%2'").arg(offset()).arg(QLatin1Char(top.close)));
+        }
+        stack.removeLast();
+        if (!stack.isEmpty()) {
+            valueDone();
+        }
+    }
+
+    void insertComma()
+    {
+        flush();
+        out.append(',');
+        repairs.append(QString("位置 %1 处补全了缺少的逗号").arg(offset()));
+    }
+};
+
+} // namespace
+
+TolerantJsonReader::Result TolerantJsonReader::read(const QByteArray &data)
+{
+    Result result;
+    Reader reader(data);
+
+    // UTF-8 BOM
+    if (data.startsWith("\xEF\xBB\xBF")) {
+        reader.pos += 3;
+        reader.run = reader.pos;
+    }
+
+    reader.skipWhitespace();
+    if (reader.pos >= reader.end || (*reader.pos != '{' && *reader.pos != '[')) {
+        result.error = "根节点不是对象或数组";
+        return result;
+    }
+
+    bool truncated = false;
+    while (reader.pos < reader.end) {
+        char ch = *reader.pos;
+        if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r') {
+            ++reader.pos;
+            continue;
+        }
+
+        // 根节点开始之前栈为空
+        if (reader.stack.isEmpty()) {
+            ++reader.pos;
+            reader.stack.append({ch == '{' ? '}' : ']', ch == '{' ? ExpectKey : ExpectValue,
+                                 reader.outputLength(), -1});
+            continue;
+        }
+
+        Frame &top = reader.stack.last();
+        bool inObject = top.close == '}';
+
+        if (ch == '"') {
+            const char *start = reader.pos;
+            if (top.state == ExpectComma) {
+                reader.insertComma();
+                top.state = inObject ? ExpectKey : ExpectValue;
+            }
+            if (!reader.skipString()) {
+                reader.pos = reader.end;
+                truncated = true;
+                break;
+            }
+            if (top.state == ExpectKey) {
+                top.state = ExpectColon;
+                top.commaAt = -1;
+            } else if (top.state == ExpectValue) {
+                reader.valueDone();
+            } else {
+                const char *stop = reader.pos;
+                reader.pos = start;
+                reader.drop(stop);
+                reader.repairs.append(QString("删除了位置 %1 处多余的字符串").arg(start - reader.begin));
+            }
+            continue;
+        }
+
+        if (ch == '{' || ch == '[') {
+            if (top.state == ExpectComma && !inObject) {
+                reader.insertComma();
+                top.state = ExpectValue;
+            }
+            if (top.state != ExpectValue) {
+                result.error = QString("位置 %1 处的'%2'无法修复").arg(reader.offset()).arg(QLatin1Char(ch));
+                return result;
+            }
+            ++reader.pos;
+            reader.stack.append({ch == '{' ? '}' : ']', ch == '{' ? ExpectKey : ExpectValue,
+                                 reader.outputLength(), -1});
+            continue;
+        }
+
+        if (ch == '}' || ch == ']') {
+            if (ch != top.close) {
+                // 与外层匹配时说明内层缺了右括号，先补全；都不匹配时是多余的右括号
+                int match = reader.stack.size() - 2;
+                while (match >= 0 && reader.stack.at(match).close != ch) {
+                    --match;
+                }
+                if (match < 0) {
+                    reader.repairs.append(QString("删除了位置 %1 处多余的'%2'").arg(reader.offset()).arg(QLatin1Char(ch)));
+                    reader.drop(reader.pos + 1);
+                    continue;
+                }
+                while (reader.stack.size() - 1 > match) {
+                    reader.closeTop(false);
+                }
+            }
+
+            reader.closeTop(true);
+            if (reader.stack.isEmpty()) {
+                break;
+            }
+            continue;
+        }
+
+        if (ch == ',') {
+            if (top.state == ExpectComma) {
+                top.commaAt = reader.outputLength();
+                top.state = inObject ? ExpectKey : ExpectValue;
+                ++reader.pos;
+            } else {
+                reader.repairs.append(QString("删除了位置 %1 处多余的逗号").arg(reader.offset()));
+                reader.drop(reader.pos + 1);
+            }
+            continue;
+        }
+
+        if (ch == ':') {
+            if (top.state == ExpectColon) {
+                top.state = ExpectValue;
+                ++reader.pos;
+            } else {
+                reader.repairs.append(QString("删除了位置 %1 处多余的冒号").arg(reader.offset()));
+                reader.drop(reader.pos + 1);
+            }
+            continue;
+        }
+
+        // 数字或true/false/null，内容本身交给后续的完整解析检查
+        const char *stop = reader.scalarEnd();
+        if (stop == reader.end) {
+            // 值延伸到文件末尾，无法确定是否完整
+            reader.pos = reader.end;
+            truncated = true;
+            break;
+        }
+        if (top.state == ExpectComma && !inObject) {
+            reader.insertComma();
+            top.state = ExpectValue;
+        }
+        if (top.state != ExpectValue) {
+            result.error = QString("位置 %1 处的内容无法修复").arg(reader.offset());
+            return result;
+        }
+        reader.pos = stop;
+        reader.valueDone();
+    }
+
+    if (reader.stack.isEmpty()) {
+        // 根节点已结束，其后只允许空白
+        const char *rootEnd = reader.pos;
+        reader.skipWhitespace();
+        if (reader.pos < reader.end) {
+            int braces = 0;
+            int extra = int(reader.end - rootEnd);
+            for (const char *p = rootEnd; p < reader.end; ++p) {
+                if (*p == '}' || *p == ']') {
+                    ++braces;
+                } else if (*p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') {
+                    braces = -1;
+                    break;
+                }
+            }
+            if (braces > 0) {
+                reader.repairs.append(QString("删除了根节点之后多余的 %1 个右括号").arg(braces));
+            } else {
+                reader.repairs.append(QString("删除了根节点之后多余的 %1 字节内容").arg(extra));
+            }
+            reader.pos = rootEnd;
+        } else {
+            reader.pos = reader.end;
+        }
+        reader.flush();
+    } else {
+        // 文件被截断：最内层退回到最后一个完整的值，再逐层补全括号
+        reader.pos = reader.end;
+        reader.flush();
+
+        Frame &top = reader.stack.last();
+        int contentEnd = reader.out.size();
+        while (contentEnd > top.safeLength) {
+            char c = reader.out.at(contentEnd - 1);
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                break;
+            }
+            --contentEnd;
+        }
+        if (truncated || contentEnd > top.safeLength) {
+            reader.repairs.append("丢弃了文件末尾不完整的成员");
+        }
+        reader.out.truncate(top.safeLength);
+
+        for (int i = reader.stack.size() - 1; i >= 0; --i) {
+            reader.out.append(reader.stack.at(i).close);
+        }
+        reader.repairs.append(QString("文件不完整，补全了 %1 个右括号").arg(reader.stack.size()));
+    }
+
+    result.ok = true;
+    result.data = reader.repairs.isEmpty() ? data : reader.out;
+    result.repairs = reader.repairs;
+    return result;
+}
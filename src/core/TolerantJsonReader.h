@@ -0,0 +1,35 @@
+#ifndef TOLERANTJSONREADER_H
+#define TOLERANTJSONREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief 容错的JSON读取器
+ * 对原始字节只扫描一遍，修复B站客户端常见的entry文件损坏，输出可直接交给QJsonDocument解析的内容
+ *
+ * 能修复的情况：
+ * - 根对象结束后的多余内容（重写文件时残留的旧内容尾巴，多为多余的"}"）
+ * - 与当前层不匹配或没有对应开括号的右括号
+ * - 对象/数组末尾多余的逗号、重复的逗号
+ * - 文件被截断：丢弃最后一个不完整的成员并补全括号
+ *
+ * 未损坏的文件原样返回，repairs为空
+ */
+class TolerantJsonReader
+{
+public:
+    struct Result {
+        bool ok = false;        // 根节点是对象或数组，且已得到完整结构
+        QByteArray data;        // 修复后的内容（未修复时与输入相同）
+        QStringList repairs;    // 每项修复的说明
+        QString error;          // ok为false时的原因
+
+        bool repaired() const { return !repairs.isEmpty(); }
+    };
+
+    static Result read(const QByteArray &data);
+};
+
+#endif // TOLERANTJSONREADER_H
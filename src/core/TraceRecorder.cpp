@@ -0,0 +1,194 @@
+#include "TraceRecorder.h"
+#include <QThread>
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QMap>
+#include <QSet>
+#include <algorithm>
+
+TraceRecorder::TraceRecorder()
+    : m_keepEvents(false)
+{
+    m_clock.start();
+}
+
+void TraceRecorder::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_events.clear();
+    m_stages.clear();
+    m_threadIds.clear();
+    m_clock.restart();
+}
+
+qint64 TraceRecorder::now() const
+{
+    // QElapsedTimer只读访问是线程安全的
+    return m_clock.nsecsElapsed();
+}
+
+void TraceRecorder::setKeepEvents(bool keep)
+{
+    QMutexLocker locker(&m_mutex);
+    m_keepEvents = keep;
+}
+
+void TraceRecorder::record(const char *name, const QString &detail, qint64 startNs, qint64 durationNs)
+{
+    QMutexLocker locker(&m_mutex);
+    Stage &stage = m_stages[QByteArray::fromRawData(name, qstrlen(name))];
+    stage.count++;
+    stage.totalNs += durationNs;
+    if (durationNs > stage.maxNs) {
+        stage.maxNs = durationNs;
+        stage.slowest = detail;
+    }
+
+    if (!m_keepEvents) {
+        return;
+    }
+    Event event;
+    event.name = name;
+    event.detail = detail;
+    event.startNs = startNs;
+    event.durationNs = durationNs;
+    event.threadId = threadIdLocked();
+    m_events.append(event);
+}
+
+QList<TraceRecorder::Event> TraceRecorder::events() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_events;
+}
+
+int TraceRecorder::eventCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_events.size();
+}
+
+bool TraceRecorder::writeChromeTrace(const QString &filePath, QString &error) const
+{
+    QList<Event> events = this->events();
+    qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray traceEvents;
+    QSet<int> namedThreads;
+    for (const Event &event : events) {
+        // 线程名元数据，trace查看器按此分行显示
+        if (!namedThreads.contains(event.threadId)) {
+            namedThreads.insert(event.threadId);
+            QJsonObject meta;
+            meta["name"] = "thread_name";
+            meta["ph"] = "M";
+            meta["pid"] = pid;
+            meta["tid"] = event.threadId;
+            QJsonObject args;
+            args["name"] = event.threadId == 0 ? QString("scan/dispatch")
+                                               : QString("worker %1").arg(event.threadId);
+            meta["args"] = args;
+            traceEvents.append(meta);
+        }
+
+        // 完整事件(ph=X)，时间单位为微秒
+        QString name = QString::fromLatin1(event.name);
+        QJsonObject object;
+        object["name"] = name;
+        object["cat"] = name.section('.', 0, 0);
+        object["ph"] = "X";
+        object["ts"] = event.startNs / 1000.0;
+        object["dur"] = event.durationNs / 1000.0;
+        object["pid"] = pid;
+        object["tid"] = event.threadId;
+        if (!event.detail.isEmpty()) {
+            QJsonObject args;
+            args["file"] = event.detail;
+            object["args"] = args;
+        }
+        traceEvents.append(object);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = QString("无法写入性能记录: %1").arg(filePath);
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        error = QString("无法保存性能记录: %1").arg(filePath);
+        return false;
+    }
+    return true;
+}
+
+QStringList TraceRecorder::summary() const
+{
+    QMap<QString, Stage> stages;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_stages.constBegin(); it != m_stages.constEnd(); ++it) {
+            stages.insert(QString::fromLatin1(it.key()), it.value());
+        }
+    }
+
+    QStringList lines;
+    if (stages.isEmpty()) {
+        return lines;
+    }
+
+    // 按总耗时从高到低排列，时间花在哪里一目了然
+    QStringList names = stages.keys();
+    std::sort(names.begin(), names.end(), [&stages](const QString &a, const QString &b) {
+        return stages[a].totalNs > stages[b].totalNs;
+    });
+
+    lines << QString("%1 %2 %3 %4 %5  %6")
+                 .arg(QString("阶段"), -20).arg(QString("次数"), 8).arg(QString("总计(s)"), 10)
+                 .arg(QString("平均(ms)"), 10).arg(QString("最大(ms)"), 10).arg(QString("最慢"));
+    for (const QString &name : names) {
+        const Stage &stage = stages[name];
+        lines << QString("%1 %2 %3 %4 %5  %6")
+                     .arg(name, -20)
+                     .arg(stage.count, 8)
+                     .arg(stage.totalNs / 1e9, 10, 'f', 2)
+                     .arg(stage.totalNs / 1e6 / stage.count, 10, 'f', 1)
+                     .arg(stage.maxNs / 1e6, 10, 'f', 1)
+                     .arg(stage.slowest);
+    }
+    return lines;
+}
+
+int TraceRecorder::threadIdLocked()
+{
+    // 按首次出现的顺序编号，trace文件中比原始线程句柄更易读
+    Qt::HANDLE handle = QThread::currentThreadId();
+    auto it = m_threadIds.find(handle);
+    if (it == m_threadIds.end()) {
+        it = m_threadIds.insert(handle, m_threadIds.size());
+    }
+    return it.value();
+}
+
+TraceSpan::TraceSpan(TraceRecorder *recorder, const char *name, const QString &detail)
+    : m_recorder(recorder)
+    , m_name(name)
+    , m_detail(detail)
+    , m_startNs(recorder ? recorder->now() : 0)
+{
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (m_recorder) {
+        m_recorder->record(m_name, m_detail, m_startNs, m_recorder->now() - m_startNs);
+    }
+}
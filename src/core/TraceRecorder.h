@@ -0,0 +1,93 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QElapsedTimer>
+
+/**
+ * @brief 分阶段耗时记录
+ * 记录扫描和合并各阶段（目录遍历、JSON解析、媒体校验、FFmpeg、弹幕、字幕等）的墙钟时间，
+ * 使用单调时钟，可在多个线程中同时记录
+ *
+ * 结果可导出为Chrome trace-event JSON（chrome://tracing 或 Perfetto 打开），
+ * 也可生成按阶段汇总的文本表格。汇总只需按阶段累计；只有开启keepEvents时才逐条保存事件，
+ * 否则大批量扫描时记录本身会占用大量内存
+ */
+class TraceRecorder
+{
+public:
+    struct Event {
+        const char *name;       // 阶段名，如 "scan.parse_json"（字符串常量）
+        QString detail;         // 关联的文件或目录
+        qint64 startNs;         // 相对开始记录时的起始时间
+        qint64 durationNs;
+        int threadId;           // 按出现顺序编号的线程
+    };
+
+    TraceRecorder();
+
+    // 清空记录并重新计时
+    void reset();
+
+    // 是否逐条保存事件（导出trace文件时需要），默认只保存按阶段的汇总
+    void setKeepEvents(bool keep);
+
+    // 距离reset的纳秒数
+    qint64 now() const;
+
+    // name须为字符串常量，记录中只保存指针
+    void record(const char *name, const QString &detail, qint64 startNs, qint64 durationNs);
+
+    QList<Event> events() const;
+    int eventCount() const;
+
+    // 导出Chrome trace-event格式
+    bool writeChromeTrace(const QString &filePath, QString &error) const;
+
+    // 按阶段汇总：次数、总耗时、平均、最大及最慢的文件
+    QStringList summary() const;
+
+private:
+    struct Stage {
+        int count = 0;
+        qint64 totalNs = 0;
+        qint64 maxNs = 0;
+        QString slowest;
+    };
+
+    int threadIdLocked();
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    bool m_keepEvents;
+    QList<Event> m_events;
+    QHash<QByteArray, Stage> m_stages;  // 键直接引用阶段名常量，不复制
+    QHash<Qt::HANDLE, int> m_threadIds;
+};
+
+/**
+ * @brief 作用域计时
+ * 构造时开始、析构时记录一个阶段，recorder为空时不做任何事
+ */
+class TraceSpan
+{
+public:
+    TraceSpan(TraceRecorder *recorder, const char *name, const QString &detail = QString());
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    TraceRecorder *m_recorder;
+    const char *m_name;
+    QString m_detail;
+    qint64 m_startNs;
+};
+
+#endif // TRACERECORDER_H
@@ -19,6 +19,9 @@
 
 #ifdef Q_OS_WINDOWS
 #include <windows.h>
+#else
+#include <unistd.h>
+#include <cstdio>
 #endif
 
 Utils::Utils(QObject *parent)
@@ -196,6 +199,58 @@ void Utils::copyFileAsync(const QString &source, const QString &destination,
     });
 }
 
+bool Utils::linkOrCopyFile(const QString &source, const QString &destination)
+{
+    if (!QFile::exists(source)) {
+        log(QString("源文件不存在: %1").arg(source));
+        return false;
+    }
+
+    if (!ensureDirExists(QFileInfo(destination).absolutePath())) {
+        return false;
+    }
+
+    if (QFile::exists(destination)) {
+        QFile::remove(destination);
+    }
+
+#ifdef Q_OS_WINDOWS
+    QString nativeSource = QDir::toNativeSeparators(source);
+    QString nativeDestination = QDir::toNativeSeparators(destination);
+    if (CreateHardLinkW(reinterpret_cast<LPCWSTR>(nativeDestination.utf16()),
+                        reinterpret_cast<LPCWSTR>(nativeSource.utf16()), nullptr)) {
+        return true;
+    }
+#else
+    if (::link(QFile::encodeName(source).constData(), QFile::encodeName(destination).constData()) == 0) {
+        return true;
+    }
+#endif
+
+    // 跨卷或文件系统不支持硬链接
+    return QFile::copy(source, destination);
+}
+
+bool Utils::replaceFile(const QString &source, const QString &destination)
+{
+#ifdef Q_OS_WINDOWS
+    QString nativeSource = QDir::toNativeSeparators(source);
+    QString nativeDestination = QDir::toNativeSeparators(destination);
+    if (MoveFileExW(reinterpret_cast<LPCWSTR>(nativeSource.utf16()),
+                    reinterpret_cast<LPCWSTR>(nativeDestination.utf16()),
+                    MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        return true;
+    }
+#else
+    if (::rename(QFile::encodeName(source).constData(), QFile::encodeName(destination).constData()) == 0) {
+        return true;
+    }
+#endif
+
+    log(QString("无法替换文件: %1 -> %2").arg(source, destination));
+    return false;
+}
+
 bool Utils::download(const QUrl &url, const QString &destination,
                      const QNetworkRequest &request,
                      std::function<void(qint64, qint64)> progressCallback)
@@ -60,6 +60,23 @@ public:
     static void copyFileAsync(const QString &source, const QString &destination,
                               std::function<void(bool)> completionCallback);
 
+    /**
+     * @brief 硬链接文件，跨卷等无法链接时退回复制
+     * @param source 源文件路径
+     * @param destination 目标文件路径（已存在时覆盖）
+     * @return 是否成功
+     */
+    static bool linkOrCopyFile(const QString &source, const QString &destination);
+
+    /**
+     * @brief 原子改名，目标已存在时直接替换
+     * 同一卷内改名不会出现半个文件，用于把写完的临时文件换成正式文件
+     * @param source 源文件路径
+     * @param destination 目标文件路径
+     * @return 是否成功
+     */
+    static bool replaceFile(const QString &source, const QString &destination);
+
     // ==================== 网络下载工具 ====================
 
     /**
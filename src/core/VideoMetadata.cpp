@@ -0,0 +1,106 @@
+#include "VideoMetadata.h"
+#include <QHash>
+
+namespace {
+
+// 数字或数字字符串（部分客户端带av前缀）
+qint64 toId(const QVariant &value)
+{
+    bool ok = false;
+    qint64 id = value.toLongLong(&ok);
+    if (ok) {
+        return id;
+    }
+
+    QString text = value.toString();
+    if (text.startsWith(QLatin1String("av"), Qt::CaseInsensitive)) {
+        id = QStringView(text).mid(2).toLongLong(&ok);
+    }
+    return ok ? id : 0;
+}
+
+} // namespace
+
+QString StringPool::intern(const QString &text)
+{
+    if (text.isEmpty()) {
+        return QString();
+    }
+    auto it = m_strings.constFind(text);
+    if (it != m_strings.constEnd()) {
+        return *it;
+    }
+    m_strings.insert(text);
+    return text;
+}
+
+void StringPool::clear()
+{
+    m_strings.clear();
+}
+
+int StringPool::size() const
+{
+    return m_strings.size();
+}
+
+VideoMetadata::Field VideoMetadata::fieldFromName(const QString &name)
+{
+    static const QHash<QString, Field> fields = {
+        {"aid", Aid},
+        {"bid", Bvid},
+        {"cid", Cid},
+        {"title", Title},
+        {"part_title", PartTitle},
+        {"part_id", PartId},
+        {"part_num", PartNum},
+        {"cover_url", CoverUrl},
+    };
+    return fields.value(name, Unused);
+}
+
+void VideoMetadata::set(Field field, const QVariant &value, StringPool &pool)
+{
+    if (value.isNull()) {
+        return;
+    }
+
+    switch (field) {
+    case Aid:
+        aid = toId(value);
+        break;
+    case Cid:
+        cid = toId(value);
+        break;
+    case PartNum:
+        partNum = value.toInt();
+        break;
+    case Bvid:
+        bvid = pool.intern(value.toString());
+        break;
+    case Title:
+        title = pool.intern(value.toString());
+        break;
+    case PartTitle:
+        partTitle = pool.intern(value.toString());
+        break;
+    case PartId:
+        partId = pool.intern(value.toString());
+        break;
+    case CoverUrl:
+        coverUrl = pool.intern(value.toString());
+        break;
+    case Unused:
+        break;
+    }
+}
+
+QString VideoMetadata::aidText() const
+{
+    return aid > 0 ? QString::number(aid) : QString();
+}
+
+QString VideoMetadata::cidText() const
+{
+    return cid > 0 ? QString::number(cid) : QString();
+}
@@ -0,0 +1,63 @@
+#ifndef VIDEOMETADATA_H
+#define VIDEOMETADATA_H
+
+#include <QString>
+#include <QSet>
+#include <QVariant>
+
+/**
+ * @brief 字符串驻留池
+ * 相同内容只保留一份，之后返回的QString共享同一块存储
+ * 同一视频组的各分集标题、封面地址等大量重复，扫描时经此去重
+ */
+class StringPool
+{
+public:
+    QString intern(const QString &text);
+    void clear();
+    int size() const;
+
+private:
+    QSet<QString> m_strings;
+};
+
+/**
+ * @brief 视频元数据
+ * 对应模式文件parse节的固定字段，取代每个文件一份的QVariantMap
+ * - aid、cid为整数，0表示未知
+ * - 字符串字段由扫描器的StringPool驻留
+ */
+struct VideoMetadata
+{
+    // parse节中的字段名，编译模式时解析一次
+    enum Field {
+        Aid,            // aid
+        Bvid,           // bid
+        Cid,            // cid
+        Title,          // title
+        PartTitle,      // part_title
+        PartId,         // part_id
+        PartNum,        // part_num
+        CoverUrl,       // cover_url
+        Unused          // sid等只用于判断entry的字段
+    };
+
+    static Field fieldFromName(const QString &name);
+
+    qint64 aid = 0;
+    qint64 cid = 0;
+    int partNum = 0;
+    QString bvid;
+    QString title;
+    QString partTitle;
+    QString partId;
+    QString coverUrl;
+
+    void set(Field field, const QVariant &value, StringPool &pool);
+
+    // 未知时为空字符串
+    QString aidText() const;
+    QString cidText() const;
+};
+
+#endif // VIDEOMETADATA_H
@@ -2,10 +2,14 @@
 #include <QDir>
 #include <QStandardPaths>
 #include "application/MainWindow.h"
+#include "cli/BatchRunner.h"
+#include "core/LogFileSink.h"
 
 /**
  * @brief BiliCacheMerge Qt C++ 版本主函数
  *
+ * 带--batch参数时以命令行批处理模式运行，见BatchRunner
+ *
  * 程序启动流程:
  * 1. 创建QApplication实例
  * 2. 初始化应用程序设置
@@ -14,6 +18,17 @@
  */
 int main(int argc, char *argv[])
 {
+    // 批处理模式：只创建QCoreApplication，无需图形环境
+    if (BatchRunner::isBatchRequested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        app.setApplicationName("Qt B站缓存合并工具");
+        app.setApplicationVersion("2.0.0");
+        app.setOrganizationName("BiliCacheMerge");
+
+        BatchRunner runner;
+        return runner.run(app.arguments());
+    }
+
     QApplication app(argc, argv);
 
     // 设置应用程序信息
@@ -24,8 +39,14 @@ int main(int argc, char *argv[])
     // 设置应用程序样式
     app.setStyle("Fusion");
 
+    // 日志文件在后台线程写入，日志查看器默认打开该文件
+    LogFileSink logSink;
+    logSink.start();
+    logSink.installMessageHandler();
+
     // 创建并显示主窗口
     MainWindow mainWindow;
+    mainWindow.setLogSink(&logSink);
     mainWindow.show();
 
     // 如果提供了命令行参数，自动设置目录